@@ -0,0 +1,109 @@
+/**
+ * @file allocations.c
+ * @brief Counts the heap allocations per group of a `GROUP BY` query.
+ *
+ * Wraps SQLite's allocator to count every call to `xMalloc` and `xRealloc`, loads
+ * the extension and runs `GROUP BY` queries over groups of several sizes. The
+ * allocations of an aggregate are those of its query minus those of the same
+ * query with `count(v)`, which needs no allocation of its own; dividing by the
+ * number of groups gives the allocations per group. `SQLITE_STATUS_MALLOC_COUNT`
+ * cannot be used for this: it reports the allocations outstanding, and each group
+ * frees its buffer before the next one starts.
+ *
+ * Usage: allocations <extension> [groups]   (built and run by bench/allocations.sh)
+ */
+#include <sqlite3.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static sqlite3_mem_methods default_methods; // SQLite's own allocator, wrapped below.
+static sqlite3_int64 allocation_count;       // Calls to `xMalloc` and `xRealloc` so far.
+
+static void *counting_malloc(int size) {
+    allocation_count++;
+    return default_methods.xMalloc(size);
+}
+
+static void *counting_realloc(void *p, int size) {
+    allocation_count++;
+    return default_methods.xRealloc(p, size);
+}
+
+/**
+ * @brief Runs a query to completion, returning its allocation count and time.
+ */
+static sqlite3_int64 count_allocations(sqlite3 *db, const char *sql, double *seconds) {
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "%s\n", sqlite3_errmsg(db));
+        exit(1);
+    }
+    clock_t start = clock();
+    sqlite3_int64 before = allocation_count;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+    }
+    sqlite3_int64 allocations = allocation_count - before;
+    *seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    if (sqlite3_finalize(stmt) != SQLITE_OK) {
+        fprintf(stderr, "%s\n", sqlite3_errmsg(db));
+        exit(1);
+    }
+    return allocations;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <extension> [groups]\n", argv[0]);
+        return 1;
+    }
+    long groups = argc > 2 ? atol(argv[2]) : 100000;
+    static const int group_sizes[] = {3, 16, 17, 100};
+    static const char *functions[] = {"stddev_samp", "stddev_samp_resum", "median"};
+
+    sqlite3_mem_methods counting_methods;
+    sqlite3_config(SQLITE_CONFIG_GETMALLOC, &default_methods);
+    counting_methods = default_methods;
+    counting_methods.xMalloc = counting_malloc;
+    counting_methods.xRealloc = counting_realloc;
+    sqlite3_config(SQLITE_CONFIG_MALLOC, &counting_methods);
+
+    sqlite3 *db;
+    char *error = NULL;
+    if (sqlite3_open(":memory:", &db) != SQLITE_OK ||
+        sqlite3_enable_load_extension(db, 1) != SQLITE_OK ||
+        sqlite3_load_extension(db, argv[1], NULL, &error) != SQLITE_OK) {
+        fprintf(stderr, "%s\n", error ? error : sqlite3_errmsg(db));
+        return 1;
+    }
+
+    printf("%-18s %10s %10s %22s %10s\n", "function", "group size", "groups", "allocations per group", "seconds");
+    for (size_t i = 0; i < sizeof(group_sizes) / sizeof(group_sizes[0]); i++) {
+        int size = group_sizes[i];
+        long rows = groups * size;
+        char *sql = sqlite3_mprintf(
+            "DROP TABLE IF EXISTS t;"
+            "CREATE TABLE t(k INTEGER, v REAL);"
+            "WITH RECURSIVE seq(i) AS (SELECT 0 UNION ALL SELECT i + 1 FROM seq WHERE i < %ld)"
+            "INSERT INTO t SELECT i / %d, random() / 9223372036854775807.0 FROM seq;"
+            "CREATE INDEX t_k ON t(k);",
+            rows - 1, size);
+        if (sqlite3_exec(db, sql, NULL, NULL, &error) != SQLITE_OK) {
+            fprintf(stderr, "%s\n", error);
+            return 1;
+        }
+        sqlite3_free(sql);
+
+        double seconds;
+        sqlite3_int64 baseline = count_allocations(db, "SELECT k, count(v) FROM t GROUP BY k", &seconds);
+        for (size_t j = 0; j < sizeof(functions) / sizeof(functions[0]); j++) {
+            sql = sqlite3_mprintf("SELECT k, %s(v) FROM t GROUP BY k", functions[j]);
+            sqlite3_int64 allocations = count_allocations(db, sql, &seconds);
+            sqlite3_free(sql);
+            printf("%-18s %10d %10ld %22.2f %10.2f\n", functions[j], size, groups,
+                   (double)(allocations - baseline) / groups, seconds);
+        }
+    }
+    sqlite3_close(db);
+    return 0;
+}
@@ -0,0 +1,33 @@
+#!/bin/sh
+# Heap allocations per group of GROUP BY queries over many small groups.
+#
+# Builds the extension and bench/allocations.c, a small harness linked against
+# SQLite that counts every allocation SQLite makes. For groups of 3, 16, 17 and
+# 100 values it prints the allocations per group of stddev_samp, which keeps no
+# buffer, stddev_samp_resum, whose buffer stays inline up to SMALL_BUFFER_CAPACITY
+# (16) values and spills to the heap beyond, and median, which always uses the
+# heap. The sqlite3 shell cannot count allocations, hence the harness.
+#
+# The connection's buffer pool hands the buffer of one finished group to the next,
+# so the default build allocates no buffers per group beyond the first few. The
+# script therefore also runs a build without the pool (-DBUFFER_POOL_DEPTH=0),
+# showing which groups allocate a buffer at all.
+#
+# Usage: bench/allocations.sh [groups]   (from the repository root; 100000 groups by default)
+set -e
+
+GROUPS=${1:-100000}
+CC=${CC:-gcc}
+HERE=$(dirname "$0")
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+$CC -O2 -shared -fPIC -o "$BUILD/sqlite-stddev-extension.so" "$HERE/../sqlite-stddev-extension.c" -lm
+$CC -O2 -shared -fPIC -DBUFFER_POOL_DEPTH=0 -o "$BUILD/sqlite-stddev-extension-nopool.so" "$HERE/../sqlite-stddev-extension.c" -lm
+$CC -O2 $CFLAGS -o "$BUILD/allocations" "$HERE/allocations.c" $LDFLAGS -lsqlite3
+
+echo "Default build:"
+"$BUILD/allocations" "$BUILD/sqlite-stddev-extension.so" "$GROUPS"
+echo
+echo "Without the buffer pool:"
+"$BUILD/allocations" "$BUILD/sqlite-stddev-extension-nopool.so" "$GROUPS"
@@ -0,0 +1,54 @@
+#!/bin/sh
+# Cost and accuracy of the re-summing variants against the default functions.
+#
+# Builds the extension and generates a table of values around 1000 with a spread
+# of 1e-3, interrupted every 5000 rows by a burst of 50 values with a spread of
+# 1e6. A sliding frame of 1001 rows runs over it with variance_samp and
+# variance_samp_resum. The script prints the time of each query and the largest
+# relative error of each function at sampled rows whose frame holds no burst:
+# within RESUM_INTERVAL (1024) rows of the burst leaving the frame, when the
+# re-summing variant may not have rebuilt yet, and after that. The reference is
+# variance_samp_precise over the same rows as an aggregate, which never removes
+# values.
+#
+# Usage: bench/resum.sh [rows] [sqlite3 executable]   (from the repository root)
+set -e
+
+ROWS=${1:-1000000}
+SQLITE3=${2:-sqlite3}
+CC=${CC:-gcc}
+HERE=$(dirname "$0")
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+$CC -O2 -shared -fPIC -o "$BUILD/sqlite-stddev-extension.so" "$HERE/../sqlite-stddev-extension.c" -lm
+
+"$SQLITE3" -cmd ".load $BUILD/sqlite-stddev-extension.so" "$BUILD/bench.db" <<SQL
+CREATE TABLE s(id INTEGER PRIMARY KEY, v REAL);
+WITH RECURSIVE seq(i) AS (SELECT 0 UNION ALL SELECT i + 1 FROM seq WHERE i < $ROWS - 1)
+INSERT INTO s SELECT i, 1000 + (random() / 9223372036854775807.0) * CASE WHEN i % 5000 < 50 THEN 1e6 ELSE 1e-3 END FROM seq;
+
+-- Sampled rows whose frame of 1001 rows lies between two bursts, with the reference result.
+CREATE TABLE reference AS
+SELECT o.id, (SELECT variance_samp_precise(v) FROM s WHERE s.id BETWEEN o.id - 1000 AND o.id) AS exact
+FROM s AS o WHERE o.id % 5000 BETWEEN 1050 AND 4999 AND o.id % 97 = 0;
+
+.print
+.print variance_samp over ROWS BETWEEN 1000 PRECEDING AND CURRENT ROW:
+.timer on
+CREATE TABLE plain AS SELECT id, variance_samp(v) OVER (ORDER BY id ROWS BETWEEN 1000 PRECEDING AND CURRENT ROW) AS result FROM s;
+.timer off
+.print
+.print variance_samp_resum over the same frame:
+.timer on
+CREATE TABLE resum AS SELECT id, variance_samp_resum(v) OVER (ORDER BY id ROWS BETWEEN 1000 PRECEDING AND CURRENT ROW) AS result FROM s;
+.timer off
+.print
+.mode column
+SELECT function,
+       printf('%.1e', max(iif(id % 5000 < 2075, abs(result - exact) / exact, 0))) AS max_error_until_rebuild,
+       printf('%.1e', max(iif(id % 5000 >= 2075, abs(result - exact) / exact, 0))) AS max_error_after_rebuild
+FROM (SELECT 'variance_samp' AS function, id, result FROM plain
+      UNION ALL SELECT 'variance_samp_resum', id, result FROM resum) JOIN reference USING (id)
+GROUP BY function;
+SQL
@@ -3,51 +3,552 @@
  * @brief SQLite extension for calculating sample and population variance and standard deviation.
  *
  * This extension provides `stddev`, `variance`, and their aliases as user-defined aggregate
- * and window functions. It is optimized for window function performance by using a circular
- * buffer to efficiently manage the sliding window of data.
+ * and window functions. Every group or window partition is summarized by a constant-size
+ * accumulator, so memory use does not grow with the number of input rows.
  */
 #include <ctype.h>
+#include <float.h>
+#include <limits.h>
+#include <locale.h>
 #include <math.h>
 #include <sqlite3ext.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#define STATS_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define STATS_HAVE_MMAP 0
+#endif
+
 SQLITE_EXTENSION_INIT1
 
 // --- Configuration Constants ---
 
-// The initial capacity for the dynamic arrays holding values.
-#define INITIAL_CAPACITY 100
-// The factor by which the capacity of arrays is increased when they become full.
-#define CAPACITY_GROWTH_FACTOR 2
+// The capacity of the inline region of a circular buffer, stored inside the aggregate context.
+// Groups and frames with at most this many values never allocate from the heap.
+// Circular buffer capacities are powers of two, so positions wrap with a mask instead of a division.
+#ifndef SMALL_BUFFER_CAPACITY
+#define SMALL_BUFFER_CAPACITY 16
+#endif
+// The initial capacity of a circular buffer once it is spilled to the heap. A power of two.
+#define INITIAL_CAPACITY 128
+// The number of size classes kept in a connection's buffer pool. Class k holds idle heap
+// buffers of `INITIAL_CAPACITY` * 2^k doubles (or twice as many floats); larger buffers are freed.
+#ifndef BUFFER_POOL_CLASSES
+#define BUFFER_POOL_CLASSES 14
+#endif
+// The maximum number of idle buffers kept per capacity class.
+#ifndef BUFFER_POOL_DEPTH
+#define BUFFER_POOL_DEPTH 2
+#endif
+// The minimum number of inverse steps between two exact re-summations of a buffered window.
+// The effective interval is never shorter than the current frame, keeping re-summation O(1) amortized.
+#ifndef RESUM_INTERVAL
+#define RESUM_INTERVAL 1024
+#endif
+// The re-summing paired statistics rebuild before `RESUM_INTERVAL` once a departing pair has
+// cancelled a sum of squared deviations to less than 1/RESUM_CANCELLATION_RATIO of its value,
+// losing that many bits of it to rounding. They still rebuild no more often than once per frame length.
+#ifndef RESUM_CANCELLATION_RATIO
+#define RESUM_CANCELLATION_RATIO 1048576.0
+#endif
+// The default maximum size in bytes of one circular buffer, or 0 for no limit.
+// It can be changed per connection with `stats_config('max_buffer_size', N)`.
+#ifndef MAX_BUFFER_SIZE
+#define MAX_BUFFER_SIZE (256 * 1024 * 1024)
+#endif
+// The default size in bytes from which circular buffers are backed by a memory-mapped
+// temporary file instead of the heap, or 0 to never spill. Only used on POSIX systems.
+// It can be changed per connection with `stats_config('mmap_spill_size', N)`.
+#ifndef MMAP_SPILL_SIZE
+#define MMAP_SPILL_SIZE (64 * 1024 * 1024)
+#endif
+// Whether the frame buffers of the re-summing functions store values as 32-bit floats
+// instead of doubles by default.
+// It can be changed per connection with `stats_config('float32_buffers', 0 or 1)`.
+#ifndef FLOAT32_BUFFERS
+#define FLOAT32_BUFFERS 0
+#endif
+
+#if (SMALL_BUFFER_CAPACITY & (SMALL_BUFFER_CAPACITY - 1)) != 0 || SMALL_BUFFER_CAPACITY >= INITIAL_CAPACITY
+#error "SMALL_BUFFER_CAPACITY must be a power of two below INITIAL_CAPACITY"
+#endif
+
+// The format version written into serialized accumulator states (see `serialize_window_stats`).
+#define STATS_STATE_VERSION 1
+// The maximum size in bytes of a serialized accumulator state.
+#define STATS_STATE_MAX_SIZE 82
+// The size in bytes of the optional minimum/maximum section of a serialized state.
+#define STATS_STATE_MINMAX_SIZE 16
+// The factor that scales the median absolute deviation to a consistent estimator of the
+// standard deviation of normally distributed data, 1 / Phi^-1(3/4).
+#define MAD_NORMAL_SCALE 1.4826022185056018
+// The relative accuracy of quantile sketches: every estimate is within this fraction of
+// the true value of the requested rank. Sketches only merge with sketches of the same accuracy.
+#ifndef SKETCH_RELATIVE_ACCURACY
+#define SKETCH_RELATIVE_ACCURACY 0.01
+#endif
+// The maximum number of buckets a quantile sketch keeps per sign. Beyond it, the buckets
+// closest to zero are collapsed, which bounds memory independently of the input size.
+#ifndef SKETCH_MAX_BUCKETS
+#define SKETCH_MAX_BUCKETS 2048
+#endif
+// The number of buckets a quantile sketch allocates per sign for its first value.
+#define SKETCH_INITIAL_BUCKETS 64
+// The ratio between the bounds of consecutive quantile sketch buckets.
+#define SKETCH_GAMMA ((1.0 + SKETCH_RELATIVE_ACCURACY) / (1.0 - SKETCH_RELATIVE_ACCURACY))
+// The format version and type tag written into serialized quantile sketches (see `serialize_quantile_sketch`).
+#define SKETCH_STATE_VERSION 1
+#define SKETCH_STATE_TAG 'Q'
+// The size in bytes of the fixed part of a serialized quantile sketch.
+#define SKETCH_STATE_HEADER_SIZE 50
 // The minimum number of data points required for population statistics.
 #define MIN_COUNT_POPULATION 1
 // The minimum number of data points required for sample statistics.
 #define MIN_COUNT_SAMPLE 2
+// The minimum number of pairs required for the residual standard error of a regression line.
+#define MIN_COUNT_REGRESSION_RESIDUAL 3
 
 // --- End of Configuration Constants ---
 
+// Exact integer accumulation requires a native 128-bit integer type (GCC and Clang on 64-bit targets).
+// SQLite only guarantees 8-byte alignment for aggregate contexts, so the type is declared with that alignment.
+#if defined(__SIZEOF_INT128__)
+#define STATS_HAVE_INT128 1
+typedef __int128 stats_int128 __attribute__((aligned(8)));
+#else
+#define STATS_HAVE_INT128 0
+#endif
+
 /**
  * @struct WindowStatsData
  * @brief Holds the state for aggregate and window statistical calculations.
  *
  * This structure is the core of the extension, pointed to by SQLite's aggregate
- * context. For window functions, it implements a circular buffer (`values`) to
- * efficiently add and remove values from the sliding window. The `head` and `tail`
- * indices manage this buffer. For both aggregate and window modes, it maintains
- * a running `sum` and `sum_sq` (sum of squares) to allow for efficient,
- * on-the-fly calculation of variance and standard deviation.
+ * context. It is a constant-size accumulator using Welford's algorithm: instead of
+ * a running sum and sum of squares, it tracks the running `mean` and `m2`, the sum
+ * of squared deviations from that mean. This avoids the catastrophic cancellation
+ * of the `sum_sq/n - mean^2` formula when the spread of the data is small relative
+ * to its magnitude. Values are additionally shifted by the first value seen (`shift`),
+ * so the running mean stays close to zero and keeps its low-order digits even
+ * when all values share a large offset. Values leaving a window frame are removed by running the
+ * update in reverse; SQLite passes the departing row to the inverse callback, so
+ * no copy of the frame has to be kept. A zero-filled structure (as returned by
+ * `sqlite3_aggregate_context`) is a valid empty state.
+ *
+ * INTEGER inputs bypass the Welford engine and are summed exactly in 128-bit
+ * integers (`int_sum`, `int_sum_sq`), shifted by the first INTEGER value seen
+ * (`int_shift`) so that clustered large counters do not overflow the sum of
+ * squares. Removing them is exact, so sliding windows
+ * over integer data never drift. The two partitions are combined only when a
+ * result is computed (see `get_window_stats_moments`). Should the exact sum of
+ * squares ever overflow, the integer partition is folded into the Welford engine
+ * and `int_overflow` routes all further INTEGER values there as well.
+ */
+typedef struct {
+    size_t count;       // The current number of non-NULL values in the group or window frame.
+    size_t float_count; // The number of those values accumulated by the Welford engine.
+    double shift;       // Offset subtracted from every Welford value; the first value added to an empty engine.
+    double mean;        // Running mean of all shifted Welford values.
+    double m2;          // Running sum of squared deviations from the mean.
+#if STATS_HAVE_INT128
+    int int_overflow;        // Non-zero once the exact sums overflowed; INTEGER values then use the Welford engine.
+    sqlite3_int64 int_shift; // Offset subtracted from every INTEGER value; the first one added to an empty partition.
+    stats_int128 int_sum;    // Exact sum of the shifted INTEGER values.
+    stats_int128 int_sum_sq; // Exact sum of the squares of the shifted INTEGER values.
+#endif
+} WindowStatsData;
+
+/**
+ * @struct PairedStatsData
+ * @brief The accumulator of `WindowStatsData` generalized to pairs `(y, x)`, for covariance and correlation.
+ *
+ * Tracks the running means, the sums of squared deviations of both inputs and
+ * their co-moment `c_xy`, the sum of `(x - mean_x) * (y - mean_y)`. The bivariate
+ * Welford update adds and removes a pair in O(1). Both inputs are shifted by the
+ * first pair added to an empty accumulator. Pairs in which either value is NULL
+ * are skipped. A zero-filled structure is a valid empty state.
+ */
+typedef struct {
+    size_t count;   // The current number of non-NULL pairs in the group or window frame.
+    double shift_y; // Offset subtracted from every `y`; the first `y` added to an empty accumulator.
+    double shift_x; // Offset subtracted from every `x`; the first `x` added to an empty accumulator.
+    double mean_y;  // Running mean of the shifted `y` values.
+    double mean_x;  // Running mean of the shifted `x` values.
+    double m2_y;    // Running sum of squared deviations of `y` from its mean.
+    double m2_x;    // Running sum of squared deviations of `x` from its mean.
+    double c_xy;    // Running co-moment: sum of the products of both deviations.
+} PairedStatsData;
+
+/**
+ * @struct StatsRingBuffer
+ * @brief A growable circular buffer holding the values of a window frame.
+ *
+ * Values are appended at `tail` and removed from `head`, matching the order in
+ * which SQLite adds rows to and removes rows from a window frame. The buffer
+ * starts out in `inline_values`, which lives inside the aggregate context, and is
+ * only spilled to the heap once it holds more than `SMALL_BUFFER_CAPACITY` values.
+ * This keeps `GROUP BY` queries with many tiny groups free of heap allocations.
+ * The capacity is always a power of two, so `head` and `tail` wrap with a mask.
+ * Buffers beyond the connection's spill size live in a memory-mapped temporary
+ * file (`mapped`), so giant frames page to disk rather than to swap. Compact
+ * buffers (`compact`) store values as floats, halving their memory and cache
+ * footprint for data that needs no more than about 7 significant digits.
  */
 typedef struct {
-    double *values;  // A dynamic array of values, used as a circular buffer for window functions.
+    void *values;    // The circular buffer: `inline_values`, a heap allocation or a file mapping.
     size_t count;    // The current number of values stored in the buffer.
-    size_t capacity; // The current allocated capacity of the `values` buffer.
+    size_t capacity; // The current capacity of the `values` buffer: zero or a power of two.
     size_t head;     // Index of the oldest element (the "front" of the circular buffer).
     size_t tail;     // Index where the next new element will be inserted (the "back").
-    double sum;      // Running sum of all values in the buffer.
-    double sum_sq;   // Running sum of the squares of all values.
-} WindowStatsData;
+    int mapped;      // Non-zero if `values` is a file mapping rather than a heap allocation.
+    int compact;     // Non-zero if elements are floats rather than doubles; fixed on first use.
+    double inline_values[SMALL_BUFFER_CAPACITY]; // Inline storage used before the first spill (twice as many floats).
+} StatsRingBuffer;
+
+/**
+ * @struct StatsBufferPool
+ * @brief A per-connection free list of circular buffer storage, keyed by size class.
+ *
+ * Every window partition and aggregate group starts with an empty circular buffer.
+ * Instead of repeating the same growth ladder through the allocator for each of them,
+ * spilled buffers are returned here when a group finishes and handed out again to
+ * the next one. The pool also holds the connection's buffer settings. It is the
+ * user data of the functions that use it, shared by all their registrations on one
+ * connection and freed with the last of them. SQLite serializes calls on a
+ * connection, so no locking is needed.
+ */
+typedef struct {
+    int ref_count;                                          // The number of owners: function registrations plus the initializer.
+    sqlite3_int64 max_buffer_size;                          // The maximum size in bytes of one circular buffer, or 0 for no limit.
+    sqlite3_int64 mmap_spill_size;                          // The size in bytes from which buffers are file-backed, or 0 to never spill.
+    sqlite3_int64 float32_buffers;                          // Non-zero if new re-summing buffers store floats instead of doubles.
+    size_t idle_counts[BUFFER_POOL_CLASSES];                // Per class: the number of idle buffers.
+    void *idle_buffers[BUFFER_POOL_CLASSES][BUFFER_POOL_DEPTH]; // Per class: the idle buffers.
+} StatsBufferPool;
+
+/**
+ * @struct ResumStatsData
+ * @brief State for the re-summing (`*_resum`) functions.
+ *
+ * Long-running sliding windows accumulate rounding error in the Welford engine,
+ * since every inverse step subtracts from the running mean and m2. These functions
+ * additionally keep the window frame in a circular buffer and periodically rebuild
+ * `stats` from it with an exact two-pass computation. `stats` is the first member,
+ * so the generic value functions can read this structure as a `WindowStatsData`.
+ * If the frame outgrows the connection's buffer size limit, the buffer is dropped
+ * and the group continues with the plain Welford engine.
+ */
+typedef struct {
+    WindowStatsData stats;       // The running accumulator. Only its Welford engine is used.
+    StatsRingBuffer ring;        // The values of the current window frame.
+    size_t inverses_since_resum; // Inverse steps since `stats` was last rebuilt from `ring`.
+    int unbuffered;              // Non-zero once the frame exceeded the buffer size limit and `ring` was dropped.
+} ResumStatsData;
+
+/**
+ * @struct PairedResumStatsData
+ * @brief State for the re-summing paired statistics (`covar_samp_resum`, `corr_resum`, `regr_*_resum`).
+ *
+ * The counterpart of `ResumStatsData` for pairs: the frame's `y` and `x` values are
+ * kept in two circular buffers next to the bivariate accumulator, which is rebuilt
+ * from them with an exact two-pass computation. `stats` is the first member, so the
+ * paired value functions can read this structure as a `PairedStatsData`. If the
+ * frame outgrows the connection's buffer size limit, the buffers are dropped and the
+ * group continues with the plain bivariate Welford update.
+ */
+typedef struct {
+    PairedStatsData stats;       // The running accumulator.
+    StatsRingBuffer ys;          // The `y` values of the current window frame.
+    StatsRingBuffer xs;          // The `x` values of the current window frame, in the same order.
+    size_t inverses_since_resum; // Inverse steps since `stats` was last rebuilt from the buffers.
+    int cancelled;               // Non-zero if a departing pair has cancelled most of `m2_y` or `m2_x` since the last rebuild.
+    int unbuffered;              // Non-zero once the frame exceeded the buffer size limit and the buffers were dropped.
+} PairedResumStatsData;
+
+/**
+ * @struct DoubleDouble
+ * @brief An unevaluated sum `hi + lo` of two doubles, giving about 106 bits of precision.
+ */
+typedef struct {
+    double hi; // The leading component.
+    double lo; // The trailing component, at most half an ulp of `hi`.
+} DoubleDouble;
+
+/**
+ * @struct PreciseStatsData
+ * @brief State for the double-double precision (`*_precise`) functions.
+ *
+ * Values are shifted by the first value seen, and the shifted values and their
+ * squares are accumulated in double-double arithmetic. The shift is exact: an
+ * INTEGER shift is kept as an integer, and INTEGER values are split into two
+ * exact halves rather than rounded to double. The squares are accurate to about
+ * 106 bits. Adding and removing values is O(1), and the error of the result is
+ * dominated by the final rounding to double.
+ * Before a result is computed, the double-double sums are condensed into `stats`,
+ * which is the first member so the generic calculation functions can read it.
+ */
+typedef struct {
+    WindowStatsData stats; // Snapshot of the sums in the form read by the calculation functions.
+    size_t count;          // The current number of non-NULL values.
+    double shift;          // Offset subtracted from every value; the first value added to an empty accumulator.
+    sqlite3_int64 int_shift; // The shift, if the first value was an INTEGER.
+    int shift_is_integer;  // Non-zero if the shift is `int_shift`.
+    DoubleDouble sum;      // Sum of the shifted values.
+    DoubleDouble sum_sq;   // Sum of the squares of the shifted values.
+} PreciseStatsData;
+
+/**
+ * @struct EwStatsData
+ * @brief State for the exponentially weighted `ew_*` functions.
+ *
+ * A Welford accumulator over weighted values, where each new value has weight 1
+ * and all earlier weights are multiplied by `decay = 1 - alpha` first. The state
+ * has a constant size regardless of the frame length.
+ */
+typedef struct {
+    size_t count;          // The current number of non-NULL values.
+    double shift;          // Offset subtracted from every value; the first value added to an empty accumulator.
+    double sum_weights;    // The sum of the weights.
+    double sum_weights_sq; // The sum of the squared weights, for the bias correction.
+    double mean;           // The weighted mean of the shifted values.
+    double m2;             // The weighted sum of squared deviations from the mean.
+    double decay;          // The factor applied to all weights per new value.
+    int decay_known;       // Non-zero once the decay has been read from a row.
+} EwStatsData;
+
+/**
+ * @struct DecayedStatsData
+ * @brief State for the time-decayed `decayed_*` functions.
+ *
+ * Weights are `2^(-(latest_time - ts) / half_life)`. When a later timestamp
+ * arrives, the accumulated weights are rescaled to it, so every update is O(1).
+ * `stats` is the first member so the exponentially weighted result functions can read it.
+ */
+typedef struct {
+    EwStatsData stats;   // The weighted accumulator; its `decay` is unused.
+    double latest_time;  // The latest timestamp seen, at which a weight is 1.
+    double half_life;    // The time after which a weight has halved.
+    int half_life_known; // Non-zero once the half-life has been read from a row.
+} DecayedStatsData;
+
+/**
+ * @struct TimeWeightedStatsData
+ * @brief State for the `time_weighted_*` functions over a piecewise-constant signal.
+ *
+ * Each sample holds its value until the next one. A frame covers the intervals
+ * between its own rows, so a row adds the previous row's value, weighted by the
+ * time since that row. A row leaving the frame removes its own interval, which
+ * ends at the timestamp of the next row. The timestamps of the frame are kept in a
+ * circular buffer to find it, so both directions are O(1).
+ * `stats` is the first member so the exponentially weighted result functions can read it.
+ * If the buffer outgrows the connection's buffer size limit, it is dropped; the
+ * group can then still be aggregated, but no row can leave it.
+ */
+typedef struct {
+    EwStatsData stats;     // The duration-weighted accumulator; its `decay` is unused.
+    double last_value;     // The value of the latest row, whose holding interval is still open.
+    double last_time;      // The timestamp of the latest row.
+    int has_last;          // Non-zero while the frame holds a row.
+    int unbuffered;        // Non-zero once the frame exceeded the buffer size limit and `times` was dropped.
+    StatsRingBuffer times; // The timestamps of the rows of the frame, oldest first.
+} TimeWeightedStatsData;
+
+/**
+ * @struct SummaryStatsData
+ * @brief State for the `stats_summary` family, computing several statistics in one pass.
+ *
+ * Extends the accumulator with the minimum and maximum. `stats` is the first member,
+ * so the generic calculation functions can read this structure as a `WindowStatsData`.
+ * To update the minimum and maximum when a value leaves a sliding window frame,
+ * the candidates are kept in the monotonic deques of `rolling_min` and `rolling_max`.
+ * If a deque outgrows the connection's buffer size limit, both are dropped, and the
+ * minimum and maximum become unknown at the next inverse step until the frame is
+ * empty again.
+ */
+typedef struct {
+    WindowStatsData stats;     // The running accumulator.
+    double min;                // The smallest value of the frame (valid when `stats.count > 0` and `minmax_unknown` is 0).
+    double max;                // The largest value of the frame (valid when `stats.count > 0` and `minmax_unknown` is 0).
+    int minmax_unknown;        // Non-zero once a value has left the window frame without the deques to update `min` and `max`.
+    int unbuffered;            // Non-zero once a deque exceeded the buffer size limit and both were dropped.
+    StatsRingBuffer min_deque; // The candidates for the minimum, non-decreasing from head to tail.
+    StatsRingBuffer max_deque; // The candidates for the maximum, non-increasing from head to tail.
+} SummaryStatsData;
+
+/**
+ * @brief The individual statistics reported by the `stats_summary` family.
+ */
+typedef enum {
+    SUMMARY_COUNT,
+    SUMMARY_MEAN,
+    SUMMARY_MIN,
+    SUMMARY_MAX,
+    SUMMARY_VARIANCE_SAMP,
+    SUMMARY_VARIANCE_POP,
+    SUMMARY_STDDEV_SAMP,
+    SUMMARY_STDDEV_POP,
+    SUMMARY_STDERR,
+    SUMMARY_CV,
+    SUMMARY_FIELD_COUNT
+} SummaryField;
+
+/**
+ * @struct MultiColumnStatsData
+ * @brief State for `stddev_cols`, accumulating several columns in one aggregate context.
+ *
+ * The per-column Welford accumulators are stored as a structure of arrays directly
+ * behind this header, inside the same aggregate context allocation, so a row updates
+ * all columns with a single context lookup and sequential memory accesses. The arrays
+ * are sized by the number of arguments on the first call.
+ */
+typedef struct {
+    int column_count; // The number of columns (arguments).
+    size_t *counts;   // Per column: the number of non-NULL values.
+    double *shifts;   // Per column: the offset subtracted from every value (the first value seen).
+    double *means;    // Per column: the running mean of the shifted values.
+    double *m2s;      // Per column: the running sum of squared deviations from the mean.
+} MultiColumnStatsData;
+
+/**
+ * @struct QuantileData
+ * @brief State for the order statistics functions (`median`, `percentile_cont`, `percentile_disc`, `quantiles`)
+ * and for `mad` and `mad_normal`.
+ *
+ * Order statistics need every value of the group or window frame, so the values are
+ * kept in a circular buffer. Results are input values or computed from them, so the
+ * buffer always holds doubles, whatever the `float32_buffers` setting. The requested fractions, and scratch space for the ranks
+ * to select (two per fraction), are stored directly behind this header, inside the
+ * same aggregate context allocation. They are sized by the number of arguments on
+ * the first call.
+ */
+typedef struct {
+    StatsRingBuffer ring; // The values of the group or window frame.
+    int fraction_count;   // The number of requested fractions; 0 before the first call.
+    int fractions_known;  // Non-zero once the fractions have been read from a row.
+    double *fractions;    // The requested fractions between 0 and 1, in argument order.
+    size_t *ranks;        // Scratch space for the 0-based ranks to select.
+} QuantileData;
+
+/**
+ * @struct TreapNode
+ * @brief A node of an `OrderStatisticTree`.
+ */
+typedef struct {
+    double value;          // The value.
+    unsigned int priority; // The random heap priority; parents have higher priorities than their children.
+    unsigned int left;     // Index of the left child (smaller values), or 0.
+    unsigned int right;    // Index of the right child (greater or equal values), or 0.
+    unsigned int size;     // The number of nodes in the subtree rooted here.
+} TreapNode;
+
+/**
+ * @struct OrderStatisticTree
+ * @brief A multiset of doubles supporting insertion, deletion and selection by rank in O(log n).
+ *
+ * A treap (a binary search tree kept balanced in expectation by random heap
+ * priorities) whose nodes carry subtree sizes. Nodes live in one growable array
+ * and refer to each other by index, so growing the array never invalidates links,
+ * and deleted nodes are recycled through a free list. Index 0 is a sentinel for
+ * "no node" with a size of 0. A zero-filled structure is an empty tree.
+ */
+typedef struct {
+    TreapNode *nodes;   // The node array; `nodes[0]` is the sentinel.
+    size_t capacity;    // The allocated number of nodes, including the sentinel.
+    size_t used;        // The highest node index handed out so far.
+    unsigned int root;  // Index of the root node, or 0 for an empty tree.
+    unsigned int free_list; // Index of the first recycled node, chained through `left`, or 0.
+    unsigned int seed;  // The state of the xorshift generator for priorities.
+} OrderStatisticTree;
+
+/**
+ * @struct RollingQuantileData
+ * @brief State for `rolling_median` and `rolling_quantile`.
+ */
+typedef struct {
+    OrderStatisticTree tree; // The values of the window frame.
+    int fraction_known;      // Non-zero once the fraction has been read from a row.
+    double fraction;         // The requested fraction between 0 and 1.
+} RollingQuantileData;
+
+/**
+ * @struct SketchStore
+ * @brief The buckets of one sign of a `QuantileSketchData`.
+ *
+ * A dense array of counts for a contiguous range of bucket indexes, which grows
+ * as needed up to `SKETCH_MAX_BUCKETS`. A zero-filled structure is an empty store.
+ * Collapsed values sit in the collapse bucket rather than in their own bucket, so
+ * their removal must find them there. Window frames remove values in the order they
+ * were added, so the next `collapse_pending` removals are of values that were present
+ * at the latest collapse, and are mapped onto the collapse bucket. Later values
+ * keep their own buckets.
+ */
+typedef struct {
+    sqlite3_int64 *counts; // counts[i] is the number of values in bucket `offset + i`.
+    int offset;            // The bucket index of counts[0].
+    int capacity;          // The number of buckets allocated.
+    int collapse_index;    // The bucket into which lower buckets were collapsed at the latest collapse.
+    sqlite3_int64 collapse_pending; // The number of values present at the latest collapse that are still in the store.
+    sqlite3_int64 total;   // The sum of all counts.
+} SketchStore;
+
+/**
+ * @struct QuantileSketchData
+ * @brief A mergeable quantile sketch with bounded relative error (DDSketch).
+ *
+ * Every non-zero value falls into the bucket `ceil(log_gamma(|x|))` of the store
+ * for its sign, and every estimate is the midpoint of a bucket, so it is within
+ * `SKETCH_RELATIVE_ACCURACY` of the true value. Unlike rank-error sketches
+ * (t-digest, KLL), buckets are plain counts: values and whole sketches can be
+ * removed again exactly, which makes the sketch usable for sliding windows.
+ */
+typedef struct {
+    SketchStore negative;     // The buckets of the magnitudes of negative values.
+    SketchStore positive;     // The buckets of positive values.
+    sqlite3_int64 zero_count; // The number of zeros.
+    int fraction_known;       // Non-zero once the fraction has been read from a row (`approx_quantile`).
+    double fraction;          // The requested fraction between 0 and 1.
+} QuantileSketchData;
+
+/**
+ * @struct RollingExtremaData
+ * @brief State for `rolling_min`, `rolling_max` and `rolling_range`.
+ *
+ * Two monotonic deques over the frame's values in arrival order. The minimum deque
+ * only keeps values that are not greater than any later value, so it is
+ * non-decreasing and its head is the minimum of the frame; the maximum deque is
+ * the mirror image. Each value is pushed and popped at most once per deque.
+ */
+typedef struct {
+    StatsRingBuffer min_deque; // The candidates for the minimum, non-decreasing from head to tail.
+    StatsRingBuffer max_deque; // The candidates for the maximum, non-increasing from head to tail.
+    size_t count;              // The number of values in the frame.
+} RollingExtremaData;
+
+/**
+ * @enum ExtremaKind
+ * @brief Which result `rolling_extrema_helper` computes.
+ */
+typedef enum {
+    EXTREMA_MIN,  // The minimum of the frame.
+    EXTREMA_MAX,  // The maximum of the frame.
+    EXTREMA_RANGE // The maximum minus the minimum.
+} ExtremaKind;
+
+/**
+ * @enum QuantileMethod
+ * @brief How a quantile is derived from the sorted values.
+ */
+typedef enum {
+    QUANTILE_CONTINUOUS, // Interpolate linearly between the two closest ranks (`percentile_cont`).
+    QUANTILE_DISCRETE    // Use the value at the closest lower rank (`percentile_disc`).
+} QuantileMethod;
 
 /**
  * @struct StatsFunctionGroup
@@ -57,13 +558,21 @@ typedef struct {
 typedef struct {
     const char **names;                // Array of function names/aliases.
     size_t name_count;                 // Number of names in the array.
+    int arg_count;                     // Number of SQL arguments, or -1 for any number.
+    void (*xFunc)(sqlite3_context *, int, sqlite3_value **);    // Pointer to the scalar function, or NULL for aggregates.
+    void (*xStep)(sqlite3_context *, int, sqlite3_value **);    // Pointer to the xStep function.
+    void (*xInverse)(sqlite3_context *, int, sqlite3_value **); // Pointer to the xInverse function.
     void (*xValue)(sqlite3_context *); // Pointer to the xValue function.
     void (*xFinal)(sqlite3_context *); // Pointer to the xFinal function.
+    StatsBufferPool *pool;             // The connection's buffer pool passed as user data, or NULL.
 } StatsFunctionGroup;
 
 // A function pointer type for the statistical calculation functions.
 typedef double (*stats_func)(const WindowStatsData *);
 
+// A function pointer type for the calculation functions over pairs.
+typedef double (*paired_func)(const PairedStatsData *);
+
 // --- Forward Declarations ---
 
 // Core Calculation Logic
@@ -71,6 +580,18 @@ static double calculate_variance_sample(const WindowStatsData *data);
 static double calculate_variance_population(const WindowStatsData *data);
 static double calculate_stddev_sample(const WindowStatsData *data);
 static double calculate_stddev_population(const WindowStatsData *data);
+static double calculate_covariance_sample(const PairedStatsData *data);
+static double calculate_covariance_population(const PairedStatsData *data);
+static double calculate_correlation(const PairedStatsData *data);
+static double calculate_regr_slope(const PairedStatsData *data);
+static double calculate_regr_intercept(const PairedStatsData *data);
+static double calculate_regr_r2(const PairedStatsData *data);
+static double calculate_regr_avgx(const PairedStatsData *data);
+static double calculate_regr_avgy(const PairedStatsData *data);
+static double calculate_regr_sxx(const PairedStatsData *data);
+static double calculate_regr_syy(const PairedStatsData *data);
+static double calculate_regr_sxy(const PairedStatsData *data);
+static double calculate_regr_residual_stderr(const PairedStatsData *data);
 
 // SQLite Callback Functions
 static void stats_step(sqlite3_context *context, int argc, sqlite3_value **argv);
@@ -83,19 +604,245 @@ static void stddev_samp_final(sqlite3_context *context);
 static void stddev_pop_final(sqlite3_context *context);
 static void variance_samp_final(sqlite3_context *context);
 static void variance_pop_final(sqlite3_context *context);
-static void stats_destroy(void *pAggregate);
+static void resum_step(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void resum_inverse(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void stddev_samp_resum_final(sqlite3_context *context);
+static void stddev_pop_resum_final(sqlite3_context *context);
+static void variance_samp_resum_final(sqlite3_context *context);
+static void variance_pop_resum_final(sqlite3_context *context);
+static void precise_step(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void precise_inverse(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void stddev_samp_precise_value(sqlite3_context *context);
+static void stddev_pop_precise_value(sqlite3_context *context);
+static void variance_samp_precise_value(sqlite3_context *context);
+static void variance_pop_precise_value(sqlite3_context *context);
+static void stddev_samp_precise_final(sqlite3_context *context);
+static void stddev_pop_precise_final(sqlite3_context *context);
+static void variance_samp_precise_final(sqlite3_context *context);
+static void variance_pop_precise_final(sqlite3_context *context);
+static void ew_alpha_step(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void ew_halflife_step(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void ew_inverse(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void decayed_step(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void decayed_inverse(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void time_weighted_step(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void time_weighted_inverse(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void time_weighted_avg_value(sqlite3_context *context);
+static void time_weighted_avg_final(sqlite3_context *context);
+static void time_weighted_variance_final(sqlite3_context *context);
+static void time_weighted_stddev_final(sqlite3_context *context);
+static void free_time_weighted_buffer(sqlite3_context *context);
+static void paired_step(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void paired_inverse(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void paired_resum_step(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void paired_resum_inverse(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void covar_samp_resum_final(sqlite3_context *context);
+static void covar_pop_resum_final(sqlite3_context *context);
+static void corr_resum_final(sqlite3_context *context);
+static void regr_slope_resum_final(sqlite3_context *context);
+static void regr_intercept_resum_final(sqlite3_context *context);
+static void regr_r2_resum_final(sqlite3_context *context);
+static void regr_avgx_resum_final(sqlite3_context *context);
+static void regr_avgy_resum_final(sqlite3_context *context);
+static void regr_sxx_resum_final(sqlite3_context *context);
+static void regr_syy_resum_final(sqlite3_context *context);
+static void regr_sxy_resum_final(sqlite3_context *context);
+static void regr_residual_stderr_resum_final(sqlite3_context *context);
+static void covar_samp_value(sqlite3_context *context);
+static void covar_pop_value(sqlite3_context *context);
+static void corr_value(sqlite3_context *context);
+static void regr_count_value(sqlite3_context *context);
+static void regr_slope_value(sqlite3_context *context);
+static void regr_intercept_value(sqlite3_context *context);
+static void regr_r2_value(sqlite3_context *context);
+static void regr_avgx_value(sqlite3_context *context);
+static void regr_avgy_value(sqlite3_context *context);
+static void regr_sxx_value(sqlite3_context *context);
+static void regr_syy_value(sqlite3_context *context);
+static void regr_sxy_value(sqlite3_context *context);
+static void regr_residual_stderr_value(sqlite3_context *context);
+static void ew_variance_samp_value(sqlite3_context *context);
+static void ew_variance_pop_value(sqlite3_context *context);
+static void ew_stddev_samp_value(sqlite3_context *context);
+static void ew_stddev_pop_value(sqlite3_context *context);
+static void merge_step(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void merge_inverse(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void state_value(sqlite3_context *context);
+static void state_final(sqlite3_context *context);
+static void stddev_samp_finalize(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void stddev_pop_finalize(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void variance_samp_finalize(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void variance_pop_finalize(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void summary_step(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void summary_inverse(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void summary_json_value(sqlite3_context *context);
+static void summary_json_final(sqlite3_context *context);
+static void summary_blob_value(sqlite3_context *context);
+static void summary_blob_final(sqlite3_context *context);
+static void summary_count(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void summary_mean(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void summary_min(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void summary_max(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void summary_variance_samp(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void summary_variance_pop(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void summary_stddev_samp(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void summary_stddev_pop(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void summary_stderr(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void summary_cv(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void stddev_cols_step(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void stddev_cols_inverse(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void stddev_cols_value(sqlite3_context *context);
+static void stddev_cols_final(sqlite3_context *context);
+static void quantile_step(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void quantiles_step(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void quantile_inverse(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void percentile_cont_value(sqlite3_context *context);
+static void percentile_cont_final(sqlite3_context *context);
+static void percentile_disc_value(sqlite3_context *context);
+static void percentile_disc_final(sqlite3_context *context);
+static void quantiles_value(sqlite3_context *context);
+static void quantiles_final(sqlite3_context *context);
+static void rolling_quantile_step(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void rolling_quantile_inverse(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void rolling_quantile_value(sqlite3_context *context);
+static void rolling_quantile_final(sqlite3_context *context);
+static void sketch_step(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void sketch_inverse(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void sketch_merge_step(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void sketch_merge_inverse(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void approx_quantile_value(sqlite3_context *context);
+static void approx_quantile_final(sqlite3_context *context);
+static void sketch_state_value(sqlite3_context *context);
+static void sketch_state_final(sqlite3_context *context);
+static void quantile_sketch_finalize(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void rolling_extrema_step(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void rolling_extrema_inverse(sqlite3_context *context, int argc, sqlite3_value **argv);
+static void rolling_min_value(sqlite3_context *context);
+static void rolling_min_final(sqlite3_context *context);
+static void rolling_max_value(sqlite3_context *context);
+static void rolling_max_final(sqlite3_context *context);
+static void rolling_range_value(sqlite3_context *context);
+static void rolling_range_final(sqlite3_context *context);
+static void mad_value(sqlite3_context *context);
+static void mad_final(sqlite3_context *context);
+static void mad_normal_value(sqlite3_context *context);
+static void mad_normal_final(sqlite3_context *context);
+static void rolling_mad_value(sqlite3_context *context);
+static void rolling_mad_final(sqlite3_context *context);
+static void rolling_mad_normal_value(sqlite3_context *context);
+static void rolling_mad_normal_final(sqlite3_context *context);
+static void stats_config(sqlite3_context *context, int argc, sqlite3_value **argv);
 
 // Helper Functions
-static double get_circular_value(const WindowStatsData *data, size_t logical_index);
-static void add_to_circular_buffer(WindowStatsData *data, double value);
-static double remove_from_circular_buffer(WindowStatsData *data);
-static int init_window_stats_data(WindowStatsData *data);
-static int grow_stats_buffer(WindowStatsData *data);
+static int check_numeric_argument(sqlite3_context *context, sqlite3_value *value);
+static void add_to_window_stats(WindowStatsData *data, double value);
+static void remove_from_window_stats(WindowStatsData *data, double value);
+static void add_integer_to_window_stats(WindowStatsData *data, sqlite3_int64 value);
+static void remove_integer_from_window_stats(WindowStatsData *data, sqlite3_int64 value);
+static void get_window_stats_moments(const WindowStatsData *data, double *mean, double *m2);
+static void add_moments_to_window_stats(WindowStatsData *data, size_t n, double shift, double mean, double m2);
+static void merge_window_stats(WindowStatsData *data, const WindowStatsData *other);
+static void remove_moments_from_window_stats(WindowStatsData *data, size_t n, double shift, double mean, double m2);
+static void unmerge_window_stats(WindowStatsData *data, const WindowStatsData *other);
+static size_t serialize_window_stats(const WindowStatsData *data, unsigned char *buffer);
+static int deserialize_window_stats(const unsigned char *buffer, int size, WindowStatsData *data);
+static void put_uint64(unsigned char *buffer, sqlite3_uint64 value);
+static sqlite3_uint64 get_uint64(const unsigned char *buffer);
+static void put_double(unsigned char *buffer, double value);
+static double get_double(const unsigned char *buffer);
+static size_t serialize_summary_stats(const SummaryStatsData *data, unsigned char *buffer);
+static int deserialize_summary_stats(const unsigned char *buffer, int size, SummaryStatsData *data);
+static double calculate_summary_field(const SummaryStatsData *data, SummaryField field);
+static void append_json_double(sqlite3_str *str, double value);
+static int parses_back_to(const char *text, double value);
+static void resum_window_stats(ResumStatsData *data);
+static void resum_paired_stats(PairedResumStatsData *data);
+static size_t get_circular_element_size(const StatsRingBuffer *ring);
+static double get_circular_value(const StatsRingBuffer *ring, size_t logical_index);
+static void add_to_circular_buffer(StatsRingBuffer *ring, double value);
+static double remove_from_circular_buffer(StatsRingBuffer *ring);
+static double remove_last_from_circular_buffer(StatsRingBuffer *ring);
+static int grow_circular_buffer(StatsRingBuffer *ring, StatsBufferPool *pool, int allow_compact);
+static void shrink_circular_buffer(StatsRingBuffer *ring);
+static void free_circular_buffer(StatsRingBuffer *ring, StatsBufferPool *pool);
+static void move_circular_buffer(StatsRingBuffer *ring, void *new_values, size_t new_capacity, int mapped, StatsBufferPool *pool);
+#if STATS_HAVE_MMAP
+static const char *get_spill_directory(void);
+static void *map_spill_buffer(size_t size);
+#endif
+static int get_buffer_pool_class(size_t size);
+static int is_buffer_size_allowed(const StatsBufferPool *pool, size_t size);
+static void *acquire_pooled_buffer(StatsBufferPool *pool, size_t min_size, size_t *size);
+static void release_pooled_buffer(StatsBufferPool *pool, void *buffer, size_t size);
+static void release_buffer_pool(void *pool);
+static DoubleDouble dd_two_sum(double a, double b);
+static DoubleDouble dd_quick_two_sum(double hi, double lo);
+static DoubleDouble dd_add(DoubleDouble a, DoubleDouble b);
+static DoubleDouble dd_mul(DoubleDouble a, DoubleDouble b);
+static DoubleDouble dd_div_double(DoubleDouble a, double b);
+static void update_precise_stats(PreciseStatsData *data, sqlite3_value *value, int sign);
+static DoubleDouble dd_from_int64(sqlite3_int64 value);
+static void sync_precise_stats(PreciseStatsData *data);
+static void ew_step_helper(sqlite3_context *context, int argc, sqlite3_value **argv, int halflife);
+static void ew_value_helper(sqlite3_context *context, int sample, int stddev);
+static void scale_ew_stats(EwStatsData *data, double factor);
+static void add_weighted_to_ew_stats(EwStatsData *data, double value, double weight);
+static void remove_weighted_from_ew_stats(EwStatsData *data, double value, double weight);
+static int read_timestamp_argument(sqlite3_context *context, sqlite3_value *value, double *timestamp);
+static void add_to_paired_stats(PairedStatsData *data, double y, double x);
+static void remove_from_paired_stats(PairedStatsData *data, double y, double x);
+static void paired_value_helper(sqlite3_context *context, paired_func func, int min_count);
+static void paired_resum_final_helper(sqlite3_context *context, paired_func func, int min_count);
 static void set_result(sqlite3_context *context, double result);
 static void stats_value_helper(sqlite3_context *context, stats_func func, int min_count);
 static void stats_final_helper(sqlite3_context *context, stats_func func, int min_count);
+static void resum_final_helper(sqlite3_context *context, stats_func func, int min_count);
+static void precise_value_helper(sqlite3_context *context, stats_func func, int min_count);
+static void precise_final_helper(sqlite3_context *context, stats_func func, int min_count);
+static void state_result_helper(sqlite3_context *context);
+static void stats_finalize_helper(sqlite3_context *context, sqlite3_value *state, stats_func func, int min_count);
+static void summary_extract_helper(sqlite3_context *context, sqlite3_value *summary, SummaryField field);
+static void summary_json_helper(sqlite3_context *context, int is_final);
+static void summary_blob_helper(sqlite3_context *context, int is_final);
+static void free_summary_deques(sqlite3_context *context, SummaryStatsData *data);
+static void stddev_cols_helper(sqlite3_context *context);
+static void quantile_result_helper(sqlite3_context *context, QuantileMethod method, int as_json, int is_final);
+static double *get_contiguous_values(StatsRingBuffer *ring, int in_place, double **scratch);
+static double get_selected_quantile(const double *values, size_t count, double fraction, QuantileMethod method);
+static void select_ranks(double *values, size_t lo, size_t hi, const size_t *ranks, size_t rank_count);
+static void introselect(double *values, size_t lo, size_t hi, size_t k);
+static void heapsort_doubles(double *values, size_t count);
+static void sift_down_doubles(double *values, size_t root, size_t count);
+static void swap_doubles(double *a, double *b);
+static int read_fraction_argument(sqlite3_context *context, sqlite3_value *value, double *fraction);
+static int insert_into_tree(OrderStatisticTree *tree, double value, const StatsBufferPool *pool);
+static int remove_from_tree(OrderStatisticTree *tree, double value);
+static double select_from_tree(const OrderStatisticTree *tree, size_t rank);
+static double get_tree_quantile(const OrderStatisticTree *tree, double fraction);
+static double select_deviation_from_tree(const OrderStatisticTree *tree, double center, size_t split, size_t rank);
+static void free_tree(OrderStatisticTree *tree);
+static unsigned int insert_treap_node(TreapNode *nodes, unsigned int root, unsigned int node);
+static unsigned int remove_treap_node(TreapNode *nodes, unsigned int root, double value, unsigned int *removed);
+static void split_treap(TreapNode *nodes, unsigned int root, double value, unsigned int *left, unsigned int *right);
+static unsigned int merge_treaps(TreapNode *nodes, unsigned int left, unsigned int right);
+static void sketch_result_helper(sqlite3_context *context, int as_state, int is_final);
+static int add_to_sketch(QuantileSketchData *sketch, double value, sqlite3_int64 delta);
+static int add_to_sketch_store(SketchStore *store, int index, sqlite3_int64 delta);
+static int resize_sketch_store(SketchStore *store, int index);
+static int get_sketch_bucket_index(double magnitude);
+static double get_sketch_bucket_value(int index);
+static double get_sketch_quantile(const QuantileSketchData *sketch, double fraction);
+static double select_from_sketch(const QuantileSketchData *sketch, sqlite3_int64 rank);
+static unsigned char *serialize_quantile_sketch(const QuantileSketchData *sketch, size_t *size);
+static int merge_quantile_sketch(QuantileSketchData *sketch, const unsigned char *buffer, int size, int sign);
+static void free_quantile_sketch(QuantileSketchData *sketch);
+static void rolling_extrema_helper(sqlite3_context *context, ExtremaKind kind, int is_final);
+static int push_to_monotonic_deque(StatsRingBuffer *deque, double value, int keep_max, StatsBufferPool *pool);
+static void mad_result_helper(sqlite3_context *context, double scale, int is_final);
+static void rolling_mad_helper(sqlite3_context *context, double scale, int is_final);
 
 // Extension Initialization
+static int create_stats_function(sqlite3 *db, const char *name, const StatsFunctionGroup *group);
 static int register_stats_function_group(sqlite3 *db, const StatsFunctionGroup *group);
 
 // --- Core Calculation Logic ---
@@ -104,20 +851,16 @@ static int register_stats_function_group(sqlite3 *db, const StatsFunctionGroup *
  * @brief Calculate the sample variance (using n-1 in the denominator).
  *
  * This uses Bessel's correction, which is standard for estimating population
- * variance from a sample, making it an unbiased estimator. The calculation
- * uses a standard two-pass approach (or one-pass with stored sums) for
- * numerical stability.
+ * variance from a sample, making it an unbiased estimator.
  * @param data The window statistics data structure.
  * @return The calculated sample variance, or NAN if count < 2.
  */
 static double calculate_variance_sample(const WindowStatsData *data) {
     if (data->count < MIN_COUNT_SAMPLE)
         return NAN;
-    double mean = data->sum / data->count;
-    // First, calculate population variance using the formula: (sum_sq / n) - mean^2
-    double variance_pop = (data->sum_sq / data->count) - (mean * mean);
-    // Then, apply Bessel's correction for sample variance.
-    return variance_pop * ((double)data->count / (data->count - 1));
+    double mean, m2;
+    get_window_stats_moments(data, &mean, &m2);
+    return m2 / (double)(data->count - 1);
 }
 
 /**
@@ -128,8 +871,9 @@ static double calculate_variance_sample(const WindowStatsData *data) {
 static double calculate_variance_population(const WindowStatsData *data) {
     if (data->count < MIN_COUNT_POPULATION)
         return NAN;
-    double mean = data->sum / data->count;
-    return (data->sum_sq / data->count) - (mean * mean);
+    double mean, m2;
+    get_window_stats_moments(data, &mean, &m2);
+    return m2 / (double)data->count;
 }
 
 /**
@@ -152,13 +896,156 @@ static double calculate_stddev_population(const WindowStatsData *data) {
     return isnan(variance) ? NAN : sqrt(variance);
 }
 
+/**
+ * @brief Calculate the sample covariance (using n-1 in the denominator).
+ * @param data The paired statistics data structure.
+ * @return The calculated sample covariance, or NAN if count < 2.
+ */
+static double calculate_covariance_sample(const PairedStatsData *data) {
+    if (data->count < MIN_COUNT_SAMPLE)
+        return NAN;
+    return data->c_xy / (double)(data->count - 1);
+}
+
+/**
+ * @brief Calculate the population covariance (using n in the denominator).
+ * @param data The paired statistics data structure.
+ * @return The calculated population covariance, or NAN if count < 1.
+ */
+static double calculate_covariance_population(const PairedStatsData *data) {
+    if (data->count < MIN_COUNT_POPULATION)
+        return NAN;
+    return data->c_xy / (double)data->count;
+}
+
+/**
+ * @brief Calculate Pearson's correlation coefficient.
+ *
+ * The result is clamped to [-1, 1], which rounding could otherwise exceed for
+ * (nearly) collinear data.
+ * @param data The paired statistics data structure.
+ * @return The calculated correlation, or NAN if either input has zero variance.
+ */
+static double calculate_correlation(const PairedStatsData *data) {
+    if (data->count < MIN_COUNT_SAMPLE || !(data->m2_x > 0.0) || !(data->m2_y > 0.0))
+        return NAN;
+    double r = data->c_xy / sqrt(data->m2_x * data->m2_y);
+    return r > 1.0 ? 1.0 : (r < -1.0 ? -1.0 : r);
+}
+
+/**
+ * @brief Calculate the slope of the least-squares line `y = slope * x + intercept`.
+ * @param data The paired statistics data structure.
+ * @return `sxy / sxx`, or NAN if all `x` are equal.
+ */
+static double calculate_regr_slope(const PairedStatsData *data) {
+    if (data->count < MIN_COUNT_POPULATION || !(data->m2_x > 0.0))
+        return NAN;
+    return data->c_xy / data->m2_x;
+}
+
+/**
+ * @brief Calculate the intercept of the least-squares line.
+ * @param data The paired statistics data structure.
+ * @return `avg(y) - slope * avg(x)`, or NAN if all `x` are equal.
+ */
+static double calculate_regr_intercept(const PairedStatsData *data) {
+    double slope = calculate_regr_slope(data);
+    if (isnan(slope))
+        return NAN;
+    return calculate_regr_avgy(data) - slope * calculate_regr_avgx(data);
+}
+
+/**
+ * @brief Calculate the coefficient of determination of the least-squares line.
+ *
+ * Follows the SQL standard: 1 if all `y` are equal, otherwise the squared
+ * correlation `sxy^2 / (sxx * syy)`.
+ * @param data The paired statistics data structure.
+ * @return The calculated R², or NAN if all `x` are equal.
+ */
+static double calculate_regr_r2(const PairedStatsData *data) {
+    if (data->count < MIN_COUNT_POPULATION || !(data->m2_x > 0.0))
+        return NAN;
+    if (!(data->m2_y > 0.0))
+        return 1.0;
+    double r2 = data->c_xy * data->c_xy / (data->m2_x * data->m2_y);
+    return r2 > 1.0 ? 1.0 : r2;
+}
+
+/**
+ * @brief Calculate the mean of the independent variable `x`.
+ * @param data The paired statistics data structure.
+ * @return The mean of `x`, or NAN if there are no pairs.
+ */
+static double calculate_regr_avgx(const PairedStatsData *data) {
+    if (data->count < MIN_COUNT_POPULATION)
+        return NAN;
+    return data->mean_x + data->shift_x;
+}
+
+/**
+ * @brief Calculate the mean of the dependent variable `y`.
+ * @param data The paired statistics data structure.
+ * @return The mean of `y`, or NAN if there are no pairs.
+ */
+static double calculate_regr_avgy(const PairedStatsData *data) {
+    if (data->count < MIN_COUNT_POPULATION)
+        return NAN;
+    return data->mean_y + data->shift_y;
+}
+
+/**
+ * @brief Calculate the sum of squared deviations of `x`.
+ * @param data The paired statistics data structure.
+ * @return `sxx`, or NAN if there are no pairs.
+ */
+static double calculate_regr_sxx(const PairedStatsData *data) {
+    return data->count < MIN_COUNT_POPULATION ? NAN : data->m2_x;
+}
+
+/**
+ * @brief Calculate the sum of squared deviations of `y`.
+ * @param data The paired statistics data structure.
+ * @return `syy`, or NAN if there are no pairs.
+ */
+static double calculate_regr_syy(const PairedStatsData *data) {
+    return data->count < MIN_COUNT_POPULATION ? NAN : data->m2_y;
+}
+
+/**
+ * @brief Calculate the sum of products of the deviations of `x` and `y`.
+ * @param data The paired statistics data structure.
+ * @return `sxy`, or NAN if there are no pairs.
+ */
+static double calculate_regr_sxy(const PairedStatsData *data) {
+    return data->count < MIN_COUNT_POPULATION ? NAN : data->c_xy;
+}
+
+/**
+ * @brief Calculate the residual standard error of the least-squares line.
+ *
+ * This is `sqrt(SSE / (n - 2))` with the residual sum of squares
+ * `SSE = syy - sxy^2 / sxx`, clamped at zero against rounding.
+ * @param data The paired statistics data structure.
+ * @return The calculated residual standard error, or NAN if count < 3 or all `x` are equal.
+ */
+static double calculate_regr_residual_stderr(const PairedStatsData *data) {
+    if (data->count < MIN_COUNT_REGRESSION_RESIDUAL || !(data->m2_x > 0.0))
+        return NAN;
+    double sse = data->m2_y - data->c_xy * data->c_xy / data->m2_x;
+    if (sse < 0.0)
+        sse = 0.0;
+    return sqrt(sse / (double)(data->count - 2));
+}
+
 // --- SQLite Callback Functions ---
 
 /**
  * @brief The "step" function, called for each row in the aggregate or window frame.
  *
  * This function adds a new value to the statistical context. It handles context
- * initialization, buffer growth, and data type validation.
+ * allocation and data type validation.
  *
  * @param context The SQLite function context.
  * @param argc The number of arguments.
@@ -170,68 +1057,48 @@ static void stats_step(sqlite3_context *context, int argc, sqlite3_value **argv)
         return;
     }
 
+    // SQLite zero-fills the context on the first call, which is a valid empty state.
     WindowStatsData *ctx = (WindowStatsData *)sqlite3_aggregate_context(context, sizeof(WindowStatsData));
     if (!ctx) {
         sqlite3_result_error_nomem(context);
         return;
     }
 
-    // Initialize context on the first call.
-    if (ctx->values == NULL) {
-        if (init_window_stats_data(ctx) != SQLITE_OK) {
-            sqlite3_result_error_nomem(context);
-            return;
-        }
-    }
-
-    // Check the type of the incoming value.
-    int value_type = sqlite3_value_type(argv[0]);
-    if (value_type == SQLITE_NULL)
-        return; // Ignore NULLs.
-
-    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT) {
-        sqlite3_result_error(context, "Invalid data type, expected numeric value.", -1);
+    // Check the type of the incoming value; NULLs are ignored.
+    int value_type = check_numeric_argument(context, argv[0]);
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
         return;
-    }
-
-    // Grow buffer if it is full.
-    if (ctx->count >= ctx->capacity) {
-        if (grow_stats_buffer(ctx) != SQLITE_OK) {
-            sqlite3_result_error_nomem(context);
-            return;
-        }
-    }
 
     // Add the new value to the context.
-    double value = sqlite3_value_double(argv[0]);
-    add_to_circular_buffer(ctx, value);
-    ctx->sum += value;
-    ctx->sum_sq += value * value;
+    if (value_type == SQLITE_INTEGER)
+        add_integer_to_window_stats(ctx, sqlite3_value_int64(argv[0]));
+    else
+        add_to_window_stats(ctx, sqlite3_value_double(argv[0]));
 }
 
 /**
  * @brief The "inverse" function, called when a row moves out of a window frame.
  *
- * This function removes the oldest value from the statistical context, which is
- * assumed to be the one leaving the window frame. It relies on the circular
- * buffer to retrieve the value that was added earliest. The arguments (`argv`)
- * are ignored, as the function maintains its own state.
+ * SQLite passes the arguments of the departing row, so the value can be removed
+ * from the running mean and m2 directly without keeping a copy of the window frame.
  * @param context The SQLite function context.
  * @param argc The number of arguments.
- * @param argv The argument values of the row leaving the window (ignored).
+ * @param argv The argument values of the row leaving the window.
  */
 static void stats_inverse(sqlite3_context *context, int argc, sqlite3_value **argv) {
     WindowStatsData *ctx = (WindowStatsData *)sqlite3_aggregate_context(context, 0);
-    if (!ctx || !ctx->values || ctx->count <= 0)
+    if (!ctx || ctx->count == 0)
         return;
 
-    // Ignore NULL values leaving the window, consistent with how they are ignored on entry.
-    if (sqlite3_value_type(argv[0]) == SQLITE_NULL)
+    // Ignore values leaving the window that were ignored or rejected on entry.
+    int value_type = sqlite3_value_type(argv[0]);
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
         return;
 
-    double removed_value = remove_from_circular_buffer(ctx);
-    ctx->sum -= removed_value;
-    ctx->sum_sq -= removed_value * removed_value;
+    if (value_type == SQLITE_INTEGER)
+        remove_integer_from_window_stats(ctx, sqlite3_value_int64(argv[0]));
+    else
+        remove_from_window_stats(ctx, sqlite3_value_double(argv[0]));
 }
 
 static void stddev_samp_value(sqlite3_context *context) { stats_value_helper(context, calculate_stddev_sample, MIN_COUNT_SAMPLE); }
@@ -245,158 +1112,3989 @@ static void variance_samp_final(sqlite3_context *context) { stats_final_helper(c
 static void variance_pop_final(sqlite3_context *context) { stats_final_helper(context, calculate_variance_population, MIN_COUNT_POPULATION); }
 
 /**
- * @brief Destructor for the aggregate context.
+ * @brief The "step" function of the re-summing functions.
  *
- * This function is registered with SQLite and is guaranteed to be called,
- * even if the query is aborted or encounters an error. It ensures that all
- * dynamically allocated memory within the context is freed, preventing memory leaks.
- * @param pAggregate The aggregate context to be destroyed.
+ * Adds the value to the Welford engine and appends it to the frame buffer.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values.
  */
-static void stats_destroy(void *pAggregate) {
-    WindowStatsData *ctx = (WindowStatsData *)pAggregate;
-    if (ctx && ctx->values) {
-        free(ctx->values);
-        ctx->values = NULL;
+static void resum_step(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    if (argc != 1) {
+        sqlite3_result_error(context, "Statistics functions require exactly 1 argument", -1);
+        return;
     }
-}
 
-// --- Helper Functions ---
+    ResumStatsData *ctx = (ResumStatsData *)sqlite3_aggregate_context(context, sizeof(ResumStatsData));
+    if (!ctx) {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
 
-/**
- * @brief Gets a value at a logical index in the circular buffer.
- * @param data The window statistics data structure.
- * @param logical_index The 0-based logical index from the start of the window.
- * @return The value at the specified logical index.
- */
-static double get_circular_value(const WindowStatsData *data, size_t logical_index) {
-    size_t physical_index = (data->head + logical_index) % data->capacity;
-    return data->values[physical_index];
-}
+    int value_type = check_numeric_argument(context, argv[0]);
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
+        return;
 
-/**
- * @brief Adds a new value to the end (tail) of the circular buffer.
- * @param data The window statistics data structure.
- * @param value The value to add.
- */
-static void add_to_circular_buffer(WindowStatsData *data, double value) {
-    data->values[data->tail] = value;
-    data->tail = (data->tail + 1) % data->capacity;
-    data->count++;
-}
+    // Grow buffer if it is full (this also performs the initial allocation).
+    if (!ctx->unbuffered && ctx->ring.count >= ctx->ring.capacity) {
+        StatsBufferPool *pool = (StatsBufferPool *)sqlite3_user_data(context);
+        int rc = grow_circular_buffer(&ctx->ring, pool, 1);
+        if (rc == SQLITE_TOOBIG) {
+            // Degrade to the bufferless engine rather than failing the query.
+            free_circular_buffer(&ctx->ring, pool);
+            ctx->ring.count = 0;
+            ctx->unbuffered = 1;
+        } else if (rc != SQLITE_OK) {
+            sqlite3_result_error_nomem(context);
+            return;
+        }
+    }
 
-/**
- * @brief Removes a value from the beginning (head) of the circular buffer.
- * @param data The window statistics data structure.
- * @return The value that was removed.
- */
-static double remove_from_circular_buffer(WindowStatsData *data) {
-    if (data->count == 0)
-        return 0.0;
-    double removed_value = data->values[data->head];
-    data->head = (data->head + 1) % data->capacity;
-    data->count--;
-    return removed_value;
+    double value = sqlite3_value_double(argv[0]);
+    if (!ctx->unbuffered)
+        add_to_circular_buffer(&ctx->ring, value);
+    add_to_window_stats(&ctx->stats, value);
 }
 
 /**
- * @brief Initializes the WindowStatsData structure.
- * @param data The WindowStatsData structure to initialize.
- * @return SQLITE_OK on success, SQLITE_NOMEM on memory allocation failure.
+ * @brief The "inverse" function of the re-summing functions.
+ *
+ * Removes the departing value from the Welford engine and the frame buffer. Once
+ * at least `RESUM_INTERVAL` inverse steps (and no fewer than the frame size) have
+ * happened since the last rebuild, the accumulator is rebuilt from the buffer,
+ * discarding the rounding error accumulated by the reverse updates.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values of the row leaving the window.
  */
-static int init_window_stats_data(WindowStatsData *data) {
-    data->capacity = INITIAL_CAPACITY;
-    data->values = (double *)malloc(data->capacity * sizeof(double));
-    if (!data->values) {
-        return SQLITE_NOMEM;
+static void resum_inverse(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    ResumStatsData *ctx = (ResumStatsData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->stats.count == 0)
+        return;
+
+    int value_type = sqlite3_value_type(argv[0]);
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
+        return;
+
+    remove_from_window_stats(&ctx->stats, sqlite3_value_double(argv[0]));
+    if (ctx->unbuffered)
+        return;
+    remove_from_circular_buffer(&ctx->ring);
+
+    ctx->inverses_since_resum++;
+    if (ctx->inverses_since_resum >= RESUM_INTERVAL && ctx->inverses_since_resum >= ctx->ring.count) {
+        resum_window_stats(ctx);
+        ctx->inverses_since_resum = 0;
     }
-    data->count = 0;
-    data->head = 0;
-    data->tail = 0;
-    data->sum = 0.0;
-    data->sum_sq = 0.0;
-    return SQLITE_OK;
 }
 
 /**
- * @brief Grows the buffer within the WindowStatsData structure.
+ * @brief Generic "final" function for the re-summing functions.
  *
- * This function allocates a new, larger buffer and copies the existing elements
- * from the old circular buffer into a contiguous block at the start of the new one.
- * This "unrolls" the circular buffer, simplifying future operations until the
- * buffer wraps around again.
- * @param data The WindowStatsData structure to grow.
- * @return SQLITE_OK on success, SQLITE_NOMEM on memory allocation failure.
+ * Calculates the result like `stats_final_helper` and then returns the frame buffer
+ * to the connection's pool. SQLite calls xFinal exactly once for every aggregate
+ * context it allocated, even when a query is aborted, so this is the only place
+ * the buffer has to be released.
+ * @param context The SQLite function context.
+ * @param func The specific statistical function to call.
+ * @param min_count The minimum number of data points required.
  */
-static int grow_stats_buffer(WindowStatsData *data) {
-    size_t new_capacity = data->capacity * CAPACITY_GROWTH_FACTOR;
-    double *new_values = (double *)malloc(new_capacity * sizeof(double));
-    if (!new_values) {
-        return SQLITE_NOMEM;
-    }
-    // Copy existing data to the new, larger buffer.
-    for (size_t i = 0; i < data->count; i++) {
-        new_values[i] = get_circular_value(data, i);
-    }
-    if (data->values) {
-        free(data->values);
-        data->values = NULL;
-    }
-    data->values = new_values;
-    data->capacity = new_capacity;
-    data->head = 0;
-    data->tail = data->count;
-    return SQLITE_OK;
+static void resum_final_helper(sqlite3_context *context, stats_func func, int min_count) {
+    stats_final_helper(context, func, min_count);
+    ResumStatsData *ctx = (ResumStatsData *)sqlite3_aggregate_context(context, 0);
+    if (ctx)
+        free_circular_buffer(&ctx->ring, (StatsBufferPool *)sqlite3_user_data(context));
+}
+
+static void stddev_samp_resum_final(sqlite3_context *context) { resum_final_helper(context, calculate_stddev_sample, MIN_COUNT_SAMPLE); }
+static void stddev_pop_resum_final(sqlite3_context *context) { resum_final_helper(context, calculate_stddev_population, MIN_COUNT_POPULATION); }
+static void variance_samp_resum_final(sqlite3_context *context) { resum_final_helper(context, calculate_variance_sample, MIN_COUNT_SAMPLE); }
+static void variance_pop_resum_final(sqlite3_context *context) { resum_final_helper(context, calculate_variance_population, MIN_COUNT_POPULATION); }
+
+/**
+ * @brief The "step" function of the double-double precision functions.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values.
+ */
+static void precise_step(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    if (argc != 1) {
+        sqlite3_result_error(context, "Statistics functions require exactly 1 argument", -1);
+        return;
+    }
+
+    PreciseStatsData *ctx = (PreciseStatsData *)sqlite3_aggregate_context(context, sizeof(PreciseStatsData));
+    if (!ctx) {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    int value_type = check_numeric_argument(context, argv[0]);
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
+        return;
+
+    update_precise_stats(ctx, argv[0], 1);
+}
+
+/**
+ * @brief The "inverse" function of the double-double precision functions.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values of the row leaving the window.
+ */
+static void precise_inverse(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    PreciseStatsData *ctx = (PreciseStatsData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->count == 0)
+        return;
+
+    int value_type = sqlite3_value_type(argv[0]);
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
+        return;
+
+    update_precise_stats(ctx, argv[0], -1);
+}
+
+static void stddev_samp_precise_value(sqlite3_context *context) { precise_value_helper(context, calculate_stddev_sample, MIN_COUNT_SAMPLE); }
+static void stddev_pop_precise_value(sqlite3_context *context) { precise_value_helper(context, calculate_stddev_population, MIN_COUNT_POPULATION); }
+static void variance_samp_precise_value(sqlite3_context *context) { precise_value_helper(context, calculate_variance_sample, MIN_COUNT_SAMPLE); }
+static void variance_pop_precise_value(sqlite3_context *context) { precise_value_helper(context, calculate_variance_population, MIN_COUNT_POPULATION); }
+
+static void stddev_samp_precise_final(sqlite3_context *context) { precise_final_helper(context, calculate_stddev_sample, MIN_COUNT_SAMPLE); }
+static void stddev_pop_precise_final(sqlite3_context *context) { precise_final_helper(context, calculate_stddev_population, MIN_COUNT_POPULATION); }
+static void variance_samp_precise_final(sqlite3_context *context) { precise_final_helper(context, calculate_variance_sample, MIN_COUNT_SAMPLE); }
+static void variance_pop_precise_final(sqlite3_context *context) { precise_final_helper(context, calculate_variance_population, MIN_COUNT_POPULATION); }
+
+static void ew_alpha_step(sqlite3_context *context, int argc, sqlite3_value **argv) { ew_step_helper(context, argc, argv, 0); }
+static void ew_halflife_step(sqlite3_context *context, int argc, sqlite3_value **argv) { ew_step_helper(context, argc, argv, 1); }
+
+/**
+ * @brief The "inverse" function of the exponentially weighted functions.
+ *
+ * SQLite removes rows in the order it added them, so the departing value is the
+ * oldest of the frame, whose weight is `decay^(count - 1)`.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values of the row leaving the window.
+ */
+static void ew_inverse(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    EwStatsData *ctx = (EwStatsData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->count == 0)
+        return;
+
+    int value_type = sqlite3_value_type(argv[0]);
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
+        return;
+
+    remove_weighted_from_ew_stats(ctx, sqlite3_value_double(argv[0]), pow(ctx->decay, (double)(ctx->count - 1)));
+}
+
+/**
+ * @brief The "step" function of the time-decayed functions, `decayed_stddev(x, ts, half_life)` etc.
+ *
+ * Rows with a NULL value or timestamp are skipped. A row later than all before it
+ * first rescales the accumulated weights to its timestamp; an earlier one (out of
+ * order, or within a frame ordered otherwise) gets its weight relative to the latest.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values.
+ */
+static void decayed_step(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    if (argc != 3) {
+        sqlite3_result_error(context, "Time-decayed functions require exactly 3 arguments", -1);
+        return;
+    }
+
+    DecayedStatsData *ctx = (DecayedStatsData *)sqlite3_aggregate_context(context, sizeof(DecayedStatsData));
+    if (!ctx) {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    int half_life_type = sqlite3_value_type(argv[2]);
+    double half_life = sqlite3_value_double(argv[2]);
+    if ((half_life_type != SQLITE_INTEGER && half_life_type != SQLITE_FLOAT) || !(half_life > 0.0)) {
+        sqlite3_result_error(context, "Half-life argument must be greater than 0.0", -1);
+        return;
+    }
+    if (ctx->half_life_known && half_life != ctx->half_life) {
+        sqlite3_result_error(context, "Half-life argument must be the same for all rows", -1);
+        return;
+    }
+    ctx->half_life = half_life;
+    ctx->half_life_known = 1;
+
+    int value_type = check_numeric_argument(context, argv[0]);
+    double timestamp;
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
+        return;
+    if (!read_timestamp_argument(context, argv[1], &timestamp))
+        return;
+
+    if (ctx->stats.count == 0) {
+        ctx->latest_time = timestamp;
+    } else if (timestamp > ctx->latest_time) {
+        scale_ew_stats(&ctx->stats, exp2(-(timestamp - ctx->latest_time) / half_life));
+        ctx->latest_time = timestamp;
+    }
+    add_weighted_to_ew_stats(&ctx->stats, sqlite3_value_double(argv[0]), exp2(-(ctx->latest_time - timestamp) / half_life));
+}
+
+/**
+ * @brief The "inverse" function of the time-decayed functions.
+ *
+ * The departing row's weight follows from its own timestamp, so rows can leave
+ * the frame in any order.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values of the row leaving the window.
+ */
+static void decayed_inverse(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    DecayedStatsData *ctx = (DecayedStatsData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->stats.count == 0)
+        return;
+
+    int value_type = sqlite3_value_type(argv[0]);
+    int timestamp_type = sqlite3_value_type(argv[1]);
+    if ((value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT) || (timestamp_type != SQLITE_INTEGER && timestamp_type != SQLITE_FLOAT))
+        return;
+
+    double weight = exp2(-(ctx->latest_time - sqlite3_value_double(argv[1])) / ctx->half_life);
+    remove_weighted_from_ew_stats(&ctx->stats, sqlite3_value_double(argv[0]), weight);
+}
+
+/**
+ * @brief The "step" function of the time-weighted functions, `time_weighted_stddev(x, ts)` etc.
+ *
+ * Closes the holding interval of the previous row: its value is added with the
+ * time elapsed until this row as weight. The timestamp is appended to the frame
+ * buffer. Rows with a NULL value or timestamp are skipped. Timestamps must not
+ * decrease.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values.
+ */
+static void time_weighted_step(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    if (argc != 2) {
+        sqlite3_result_error(context, "Time-weighted functions require exactly 2 arguments", -1);
+        return;
+    }
+
+    TimeWeightedStatsData *ctx = (TimeWeightedStatsData *)sqlite3_aggregate_context(context, sizeof(TimeWeightedStatsData));
+    if (!ctx) {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    int value_type = check_numeric_argument(context, argv[0]);
+    double timestamp;
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
+        return;
+    if (!read_timestamp_argument(context, argv[1], &timestamp))
+        return;
+
+    if (ctx->has_last && timestamp < ctx->last_time) {
+        sqlite3_result_error(context, "Timestamps must be in ascending order", -1);
+        return;
+    }
+
+    if (!ctx->unbuffered && ctx->times.count >= ctx->times.capacity) {
+        StatsBufferPool *pool = (StatsBufferPool *)sqlite3_user_data(context);
+        int rc = grow_circular_buffer(&ctx->times, pool, 0);
+        if (rc == SQLITE_TOOBIG) {
+            // An aggregate needs no buffer; only a later inverse step fails.
+            free_circular_buffer(&ctx->times, pool);
+            ctx->times.count = 0;
+            ctx->unbuffered = 1;
+        } else if (rc != SQLITE_OK) {
+            sqlite3_result_error_nomem(context);
+            return;
+        }
+    }
+    if (!ctx->unbuffered)
+        add_to_circular_buffer(&ctx->times, timestamp);
+
+    if (ctx->has_last)
+        add_weighted_to_ew_stats(&ctx->stats, ctx->last_value, timestamp - ctx->last_time);
+    ctx->last_value = sqlite3_value_double(argv[0]);
+    ctx->last_time = timestamp;
+    ctx->has_last = 1;
+}
+
+/**
+ * @brief The "inverse" function of the time-weighted functions.
+ *
+ * SQLite removes the oldest row of the frame. Its interval ends at the timestamp
+ * of the row after it, now the head of the frame buffer, and is removed with the
+ * departing value. If the frame becomes empty, there is no such interval.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values of the row leaving the window.
+ */
+static void time_weighted_inverse(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    TimeWeightedStatsData *ctx = (TimeWeightedStatsData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || !ctx->has_last)
+        return;
+
+    int value_type = sqlite3_value_type(argv[0]);
+    int timestamp_type = sqlite3_value_type(argv[1]);
+    if ((value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT) || (timestamp_type != SQLITE_INTEGER && timestamp_type != SQLITE_FLOAT))
+        return;
+    if (ctx->unbuffered) {
+        sqlite3_result_error(context, "Time-weighted frame buffer exceeds max_buffer_size", -1);
+        return;
+    }
+
+    double departed_time = remove_from_circular_buffer(&ctx->times);
+    if (ctx->times.count == 0) {
+        // The frame is empty; the next row opens a new interval.
+        free_time_weighted_buffer(context);
+        memset(ctx, 0, sizeof(*ctx));
+        return;
+    }
+    double next_time = get_circular_value(&ctx->times, 0);
+    remove_weighted_from_ew_stats(&ctx->stats, sqlite3_value_double(argv[0]), next_time - departed_time);
+}
+
+/**
+ * @brief Returns the frame buffer of a time-weighted state to the connection's buffer pool.
+ * @param context The SQLite function context. Its user data is the connection's buffer pool.
+ */
+static void free_time_weighted_buffer(sqlite3_context *context) {
+    TimeWeightedStatsData *ctx = (TimeWeightedStatsData *)sqlite3_aggregate_context(context, 0);
+    if (ctx)
+        free_circular_buffer(&ctx->times, (StatsBufferPool *)sqlite3_user_data(context));
+}
+
+/**
+ * @brief The "value" and "final" function of `time_weighted_avg`.
+ * @param context The SQLite function context.
+ */
+static void time_weighted_avg_value(sqlite3_context *context) {
+    EwStatsData *ctx = (EwStatsData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->count == 0 || !(ctx->sum_weights > 0.0)) {
+        sqlite3_result_null(context);
+        return;
+    }
+    set_result(context, ctx->mean + ctx->shift);
+}
+
+static void time_weighted_avg_final(sqlite3_context *context) {
+    time_weighted_avg_value(context);
+    free_time_weighted_buffer(context);
+}
+static void time_weighted_variance_final(sqlite3_context *context) {
+    ew_value_helper(context, 0, 0);
+    free_time_weighted_buffer(context);
+}
+static void time_weighted_stddev_final(sqlite3_context *context) {
+    ew_value_helper(context, 0, 1);
+    free_time_weighted_buffer(context);
+}
+
+static void ew_variance_samp_value(sqlite3_context *context) { ew_value_helper(context, 1, 0); }
+static void ew_variance_pop_value(sqlite3_context *context) { ew_value_helper(context, 0, 0); }
+static void ew_stddev_samp_value(sqlite3_context *context) { ew_value_helper(context, 1, 1); }
+static void ew_stddev_pop_value(sqlite3_context *context) { ew_value_helper(context, 0, 1); }
+
+/**
+ * @brief The "step" function of the paired statistics, `covar_samp(y, x)`, `corr(y, x)` etc.
+ *
+ * Pairs in which either value is NULL are skipped, as the SQL standard requires.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values `y` and `x`.
+ */
+static void paired_step(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    if (argc != 2) {
+        sqlite3_result_error(context, "Paired statistics functions require exactly 2 arguments", -1);
+        return;
+    }
+
+    PairedStatsData *ctx = (PairedStatsData *)sqlite3_aggregate_context(context, sizeof(PairedStatsData));
+    if (!ctx) {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    int y_type = check_numeric_argument(context, argv[0]);
+    if (!y_type)
+        return;
+    int x_type = check_numeric_argument(context, argv[1]);
+    if (!x_type || y_type == SQLITE_NULL || x_type == SQLITE_NULL)
+        return;
+
+    add_to_paired_stats(ctx, sqlite3_value_double(argv[0]), sqlite3_value_double(argv[1]));
+}
+
+/**
+ * @brief The "inverse" function of the paired statistics.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values of the row leaving the window.
+ */
+static void paired_inverse(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    PairedStatsData *ctx = (PairedStatsData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->count == 0)
+        return;
+
+    // Ignore pairs leaving the window that were skipped or rejected on entry.
+    int y_type = sqlite3_value_type(argv[0]);
+    int x_type = sqlite3_value_type(argv[1]);
+    if ((y_type != SQLITE_INTEGER && y_type != SQLITE_FLOAT) || (x_type != SQLITE_INTEGER && x_type != SQLITE_FLOAT))
+        return;
+
+    remove_from_paired_stats(ctx, sqlite3_value_double(argv[0]), sqlite3_value_double(argv[1]));
+}
+
+static void covar_samp_value(sqlite3_context *context) { paired_value_helper(context, calculate_covariance_sample, MIN_COUNT_SAMPLE); }
+static void covar_pop_value(sqlite3_context *context) { paired_value_helper(context, calculate_covariance_population, MIN_COUNT_POPULATION); }
+static void corr_value(sqlite3_context *context) { paired_value_helper(context, calculate_correlation, MIN_COUNT_SAMPLE); }
+static void regr_slope_value(sqlite3_context *context) { paired_value_helper(context, calculate_regr_slope, MIN_COUNT_SAMPLE); }
+static void regr_intercept_value(sqlite3_context *context) { paired_value_helper(context, calculate_regr_intercept, MIN_COUNT_SAMPLE); }
+static void regr_r2_value(sqlite3_context *context) { paired_value_helper(context, calculate_regr_r2, MIN_COUNT_SAMPLE); }
+static void regr_avgx_value(sqlite3_context *context) { paired_value_helper(context, calculate_regr_avgx, MIN_COUNT_POPULATION); }
+static void regr_avgy_value(sqlite3_context *context) { paired_value_helper(context, calculate_regr_avgy, MIN_COUNT_POPULATION); }
+static void regr_sxx_value(sqlite3_context *context) { paired_value_helper(context, calculate_regr_sxx, MIN_COUNT_POPULATION); }
+static void regr_syy_value(sqlite3_context *context) { paired_value_helper(context, calculate_regr_syy, MIN_COUNT_POPULATION); }
+static void regr_sxy_value(sqlite3_context *context) { paired_value_helper(context, calculate_regr_sxy, MIN_COUNT_POPULATION); }
+static void regr_residual_stderr_value(sqlite3_context *context) { paired_value_helper(context, calculate_regr_residual_stderr, MIN_COUNT_REGRESSION_RESIDUAL); }
+
+/**
+ * @brief The "value" and "final" function of `regr_count`, the number of non-NULL pairs.
+ * @param context The SQLite function context.
+ */
+static void regr_count_value(sqlite3_context *context) {
+    PairedStatsData *ctx = (PairedStatsData *)sqlite3_aggregate_context(context, 0);
+    sqlite3_result_int64(context, ctx ? (sqlite3_int64)ctx->count : 0);
+}
+
+/**
+ * @brief The "step" function of the re-summing paired statistics.
+ *
+ * Like `paired_step`, and additionally appends the pair to the frame buffers.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values `y` and `x`.
+ */
+static void paired_resum_step(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    if (argc != 2) {
+        sqlite3_result_error(context, "Paired statistics functions require exactly 2 arguments", -1);
+        return;
+    }
+
+    PairedResumStatsData *ctx = (PairedResumStatsData *)sqlite3_aggregate_context(context, sizeof(PairedResumStatsData));
+    if (!ctx) {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    int y_type = check_numeric_argument(context, argv[0]);
+    if (!y_type)
+        return;
+    int x_type = check_numeric_argument(context, argv[1]);
+    if (!x_type || y_type == SQLITE_NULL || x_type == SQLITE_NULL)
+        return;
+
+    // Both buffers always hold the same number of values, so they fill up together.
+    if (!ctx->unbuffered && ctx->ys.count >= ctx->ys.capacity) {
+        StatsBufferPool *pool = (StatsBufferPool *)sqlite3_user_data(context);
+        int rc = grow_circular_buffer(&ctx->ys, pool, 1);
+        if (rc == SQLITE_OK)
+            rc = grow_circular_buffer(&ctx->xs, pool, 1);
+        if (rc == SQLITE_TOOBIG) {
+            // Degrade to the bufferless engine rather than failing the query.
+            free_circular_buffer(&ctx->ys, pool);
+            free_circular_buffer(&ctx->xs, pool);
+            ctx->ys.count = 0;
+            ctx->xs.count = 0;
+            ctx->unbuffered = 1;
+        } else if (rc != SQLITE_OK) {
+            sqlite3_result_error_nomem(context);
+            return;
+        }
+    }
+
+    double y = sqlite3_value_double(argv[0]);
+    double x = sqlite3_value_double(argv[1]);
+    if (!ctx->unbuffered) {
+        add_to_circular_buffer(&ctx->ys, y);
+        add_to_circular_buffer(&ctx->xs, x);
+    }
+    add_to_paired_stats(&ctx->stats, y, x);
+}
+
+/**
+ * @brief The "inverse" function of the re-summing paired statistics.
+ *
+ * Like `resum_inverse`: the departing pair is removed from the accumulator and the
+ * buffers, and the accumulator is rebuilt from the buffers once at least
+ * `RESUM_INTERVAL` inverse steps (and no fewer than the frame size) have happened
+ * since the last rebuild. A pair far larger than the rest of the frame, such as an
+ * outlier, leaves most of the sums of squared deviations as rounding error when it
+ * departs, so the rebuild then happens as soon as the frame size allows.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values of the row leaving the window.
+ */
+static void paired_resum_inverse(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    PairedResumStatsData *ctx = (PairedResumStatsData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->stats.count == 0)
+        return;
+
+    int y_type = sqlite3_value_type(argv[0]);
+    int x_type = sqlite3_value_type(argv[1]);
+    if ((y_type != SQLITE_INTEGER && y_type != SQLITE_FLOAT) || (x_type != SQLITE_INTEGER && x_type != SQLITE_FLOAT))
+        return;
+
+    double m2_y = ctx->stats.m2_y, m2_x = ctx->stats.m2_x;
+    remove_from_paired_stats(&ctx->stats, sqlite3_value_double(argv[0]), sqlite3_value_double(argv[1]));
+    if (ctx->unbuffered)
+        return;
+    remove_from_circular_buffer(&ctx->ys);
+    remove_from_circular_buffer(&ctx->xs);
+    if (m2_y > ctx->stats.m2_y * RESUM_CANCELLATION_RATIO || m2_x > ctx->stats.m2_x * RESUM_CANCELLATION_RATIO)
+        ctx->cancelled = 1;
+
+    ctx->inverses_since_resum++;
+    if ((ctx->cancelled || ctx->inverses_since_resum >= RESUM_INTERVAL) && ctx->inverses_since_resum >= ctx->ys.count) {
+        resum_paired_stats(ctx);
+        ctx->inverses_since_resum = 0;
+        ctx->cancelled = 0;
+    }
+}
+
+/**
+ * @brief Generic "final" function for the re-summing paired statistics.
+ *
+ * Calculates the result like `paired_value_helper` and then returns the frame
+ * buffers to the connection's pool, as `resum_final_helper` does.
+ * @param context The SQLite function context.
+ * @param func The specific calculation function to call.
+ * @param min_count The minimum number of pairs required for the calculation.
+ */
+static void paired_resum_final_helper(sqlite3_context *context, paired_func func, int min_count) {
+    paired_value_helper(context, func, min_count);
+    PairedResumStatsData *ctx = (PairedResumStatsData *)sqlite3_aggregate_context(context, 0);
+    if (ctx) {
+        StatsBufferPool *pool = (StatsBufferPool *)sqlite3_user_data(context);
+        free_circular_buffer(&ctx->ys, pool);
+        free_circular_buffer(&ctx->xs, pool);
+    }
+}
+
+static void covar_samp_resum_final(sqlite3_context *context) { paired_resum_final_helper(context, calculate_covariance_sample, MIN_COUNT_SAMPLE); }
+static void covar_pop_resum_final(sqlite3_context *context) { paired_resum_final_helper(context, calculate_covariance_population, MIN_COUNT_POPULATION); }
+static void corr_resum_final(sqlite3_context *context) { paired_resum_final_helper(context, calculate_correlation, MIN_COUNT_SAMPLE); }
+static void regr_slope_resum_final(sqlite3_context *context) { paired_resum_final_helper(context, calculate_regr_slope, MIN_COUNT_SAMPLE); }
+static void regr_intercept_resum_final(sqlite3_context *context) { paired_resum_final_helper(context, calculate_regr_intercept, MIN_COUNT_SAMPLE); }
+static void regr_r2_resum_final(sqlite3_context *context) { paired_resum_final_helper(context, calculate_regr_r2, MIN_COUNT_SAMPLE); }
+static void regr_avgx_resum_final(sqlite3_context *context) { paired_resum_final_helper(context, calculate_regr_avgx, MIN_COUNT_POPULATION); }
+static void regr_avgy_resum_final(sqlite3_context *context) { paired_resum_final_helper(context, calculate_regr_avgy, MIN_COUNT_POPULATION); }
+static void regr_sxx_resum_final(sqlite3_context *context) { paired_resum_final_helper(context, calculate_regr_sxx, MIN_COUNT_POPULATION); }
+static void regr_syy_resum_final(sqlite3_context *context) { paired_resum_final_helper(context, calculate_regr_syy, MIN_COUNT_POPULATION); }
+static void regr_sxy_resum_final(sqlite3_context *context) { paired_resum_final_helper(context, calculate_regr_sxy, MIN_COUNT_POPULATION); }
+static void regr_residual_stderr_resum_final(sqlite3_context *context) { paired_resum_final_helper(context, calculate_regr_residual_stderr, MIN_COUNT_REGRESSION_RESIDUAL); }
+
+/**
+ * @brief The "step" function of `stddev_merge`, combining serialized accumulator states.
+ *
+ * Each argument is a BLOB produced by `stddev_state` or `stddev_merge`, and is
+ * combined with the running state using the parallel (Chan et al.) formula.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values.
+ */
+static void merge_step(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    if (argc != 1) {
+        sqlite3_result_error(context, "Statistics functions require exactly 1 argument", -1);
+        return;
+    }
+
+    WindowStatsData *ctx = (WindowStatsData *)sqlite3_aggregate_context(context, sizeof(WindowStatsData));
+    if (!ctx) {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL)
+        return; // Ignore NULLs.
+
+    WindowStatsData other;
+    if (sqlite3_value_type(argv[0]) != SQLITE_BLOB ||
+        deserialize_window_stats(sqlite3_value_blob(argv[0]), sqlite3_value_bytes(argv[0]), &other) != SQLITE_OK) {
+        sqlite3_result_error(context, "Invalid data type, expected a stddev state BLOB.", -1);
+        return;
+    }
+    merge_window_stats(ctx, &other);
+}
+
+/**
+ * @brief The "inverse" function of `stddev_merge`, subtracting a departing state.
+ *
+ * This makes `stddev_merge(state) OVER (ROWS n PRECEDING)` O(1) per row over
+ * pre-aggregated buckets. Exact INTEGER sums are subtracted exactly; the Welford
+ * engine is updated by running the parallel combination formula in reverse.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values of the row leaving the window.
+ */
+static void merge_inverse(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    WindowStatsData *ctx = (WindowStatsData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->count == 0)
+        return;
+
+    // States that were ignored or rejected on entry are ignored here as well.
+    WindowStatsData other;
+    if (sqlite3_value_type(argv[0]) != SQLITE_BLOB ||
+        deserialize_window_stats(sqlite3_value_blob(argv[0]), sqlite3_value_bytes(argv[0]), &other) != SQLITE_OK)
+        return;
+    unmerge_window_stats(ctx, &other);
+}
+
+static void state_value(sqlite3_context *context) { state_result_helper(context); }
+static void state_final(sqlite3_context *context) { state_result_helper(context); }
+
+static void stddev_samp_finalize(sqlite3_context *context, int argc, sqlite3_value **argv) { stats_finalize_helper(context, argv[0], calculate_stddev_sample, MIN_COUNT_SAMPLE); }
+static void stddev_pop_finalize(sqlite3_context *context, int argc, sqlite3_value **argv) { stats_finalize_helper(context, argv[0], calculate_stddev_population, MIN_COUNT_POPULATION); }
+static void variance_samp_finalize(sqlite3_context *context, int argc, sqlite3_value **argv) { stats_finalize_helper(context, argv[0], calculate_variance_sample, MIN_COUNT_SAMPLE); }
+static void variance_pop_finalize(sqlite3_context *context, int argc, sqlite3_value **argv) { stats_finalize_helper(context, argv[0], calculate_variance_population, MIN_COUNT_POPULATION); }
+
+/**
+ * @brief The "step" function of the `stats_summary` family.
+ *
+ * Adds the value to the accumulator and the deques, and updates the minimum and maximum.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values.
+ */
+static void summary_step(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    if (argc != 1) {
+        sqlite3_result_error(context, "Statistics functions require exactly 1 argument", -1);
+        return;
+    }
+
+    SummaryStatsData *ctx = (SummaryStatsData *)sqlite3_aggregate_context(context, sizeof(SummaryStatsData));
+    if (!ctx) {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    int value_type = check_numeric_argument(context, argv[0]);
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
+        return;
+
+    double value = sqlite3_value_double(argv[0]);
+    if (!ctx->unbuffered) {
+        StatsBufferPool *pool = (StatsBufferPool *)sqlite3_user_data(context);
+        int rc = push_to_monotonic_deque(&ctx->min_deque, value, 0, pool);
+        if (rc == SQLITE_OK)
+            rc = push_to_monotonic_deque(&ctx->max_deque, value, 1, pool);
+        if (rc == SQLITE_TOOBIG) {
+            // Keep the plain running minimum and maximum rather than failing the query.
+            free_summary_deques(context, ctx);
+            ctx->unbuffered = 1;
+        } else if (rc != SQLITE_OK) {
+            sqlite3_result_error_nomem(context);
+            return;
+        }
+    }
+    if (ctx->stats.count == 0 || value < ctx->min)
+        ctx->min = value;
+    if (ctx->stats.count == 0 || value > ctx->max)
+        ctx->max = value;
+    if (value_type == SQLITE_INTEGER)
+        add_integer_to_window_stats(&ctx->stats, sqlite3_value_int64(argv[0]));
+    else
+        add_to_window_stats(&ctx->stats, value);
+}
+
+/**
+ * @brief The "inverse" function of the `stats_summary` family.
+ *
+ * Removes the departing value from the accumulator and the deques, whose heads are
+ * the new minimum and maximum. Without the deques, the minimum and maximum become
+ * unknown until the frame is empty.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values of the row leaving the window.
+ */
+static void summary_inverse(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    SummaryStatsData *ctx = (SummaryStatsData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->stats.count == 0)
+        return;
+
+    int value_type = sqlite3_value_type(argv[0]);
+    if (value_type == SQLITE_INTEGER)
+        remove_integer_from_window_stats(&ctx->stats, sqlite3_value_int64(argv[0]));
+    else if (value_type == SQLITE_FLOAT)
+        remove_from_window_stats(&ctx->stats, sqlite3_value_double(argv[0]));
+    else
+        return;
+
+    if (ctx->stats.count == 0) {
+        // The frame is empty: the next value starts the minimum and maximum afresh.
+        free_summary_deques(context, ctx);
+        ctx->minmax_unknown = 0;
+        ctx->unbuffered = 0;
+    } else if (ctx->unbuffered) {
+        ctx->minmax_unknown = 1;
+    } else {
+        // SQLite removes the oldest row; if still a candidate, it is at the head.
+        double value = sqlite3_value_double(argv[0]);
+        if (ctx->min_deque.count > 0 && get_circular_value(&ctx->min_deque, 0) == value)
+            remove_from_circular_buffer(&ctx->min_deque);
+        if (ctx->max_deque.count > 0 && get_circular_value(&ctx->max_deque, 0) == value)
+            remove_from_circular_buffer(&ctx->max_deque);
+        ctx->min = get_circular_value(&ctx->min_deque, 0);
+        ctx->max = get_circular_value(&ctx->max_deque, 0);
+    }
+}
+
+/**
+ * @brief Returns the deques of a summary state to the connection's buffer pool.
+ * @param context The SQLite function context. Its user data is the connection's buffer pool.
+ * @param data The summary state.
+ */
+static void free_summary_deques(sqlite3_context *context, SummaryStatsData *data) {
+    StatsBufferPool *pool = (StatsBufferPool *)sqlite3_user_data(context);
+    free_circular_buffer(&data->min_deque, pool);
+    free_circular_buffer(&data->max_deque, pool);
+    data->min_deque.count = 0;
+    data->max_deque.count = 0;
+}
+
+static void summary_json_value(sqlite3_context *context) { summary_json_helper(context, 0); }
+static void summary_json_final(sqlite3_context *context) { summary_json_helper(context, 1); }
+static void summary_blob_value(sqlite3_context *context) { summary_blob_helper(context, 0); }
+static void summary_blob_final(sqlite3_context *context) { summary_blob_helper(context, 1); }
+
+static void summary_count(sqlite3_context *context, int argc, sqlite3_value **argv) { summary_extract_helper(context, argv[0], SUMMARY_COUNT); }
+static void summary_mean(sqlite3_context *context, int argc, sqlite3_value **argv) { summary_extract_helper(context, argv[0], SUMMARY_MEAN); }
+static void summary_min(sqlite3_context *context, int argc, sqlite3_value **argv) { summary_extract_helper(context, argv[0], SUMMARY_MIN); }
+static void summary_max(sqlite3_context *context, int argc, sqlite3_value **argv) { summary_extract_helper(context, argv[0], SUMMARY_MAX); }
+static void summary_variance_samp(sqlite3_context *context, int argc, sqlite3_value **argv) { summary_extract_helper(context, argv[0], SUMMARY_VARIANCE_SAMP); }
+static void summary_variance_pop(sqlite3_context *context, int argc, sqlite3_value **argv) { summary_extract_helper(context, argv[0], SUMMARY_VARIANCE_POP); }
+static void summary_stddev_samp(sqlite3_context *context, int argc, sqlite3_value **argv) { summary_extract_helper(context, argv[0], SUMMARY_STDDEV_SAMP); }
+static void summary_stddev_pop(sqlite3_context *context, int argc, sqlite3_value **argv) { summary_extract_helper(context, argv[0], SUMMARY_STDDEV_POP); }
+static void summary_stderr(sqlite3_context *context, int argc, sqlite3_value **argv) { summary_extract_helper(context, argv[0], SUMMARY_STDERR); }
+static void summary_cv(sqlite3_context *context, int argc, sqlite3_value **argv) { summary_extract_helper(context, argv[0], SUMMARY_CV); }
+
+/**
+ * @brief The "step" function of `stddev_cols`, updating every column's accumulator.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments (columns).
+ * @param argv The argument values.
+ */
+static void stddev_cols_step(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    if (argc < 1) {
+        sqlite3_result_error(context, "stddev_cols requires at least 1 argument", -1);
+        return;
+    }
+
+    size_t columns = (size_t)argc;
+    size_t size = sizeof(MultiColumnStatsData) + columns * (sizeof(size_t) + 3 * sizeof(double));
+    MultiColumnStatsData *ctx = (MultiColumnStatsData *)sqlite3_aggregate_context(context, (int)size);
+    if (!ctx) {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    // Lay out the arrays behind the header on the first call.
+    if (ctx->column_count == 0) {
+        ctx->column_count = argc;
+        ctx->counts = (size_t *)(ctx + 1);
+        ctx->shifts = (double *)(ctx->counts + columns);
+        ctx->means = ctx->shifts + columns;
+        ctx->m2s = ctx->means + columns;
+    }
+
+    // Validate the whole row first, so that an error leaves no column partially updated.
+    for (int i = 0; i < argc; i++) {
+        if (!check_numeric_argument(context, argv[i]))
+            return;
+    }
+
+    for (int i = 0; i < argc; i++) {
+        if (sqlite3_value_type(argv[i]) == SQLITE_NULL)
+            continue;
+        double value = sqlite3_value_double(argv[i]);
+        if (ctx->counts[i] == 0)
+            ctx->shifts[i] = value;
+        value -= ctx->shifts[i];
+        double delta = value - ctx->means[i];
+        ctx->means[i] += delta / (double)++ctx->counts[i];
+        ctx->m2s[i] += delta * (value - ctx->means[i]);
+    }
+}
+
+/**
+ * @brief The "inverse" function of `stddev_cols`, removing a departing row from every column.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments (columns).
+ * @param argv The argument values of the row leaving the window.
+ */
+static void stddev_cols_inverse(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    MultiColumnStatsData *ctx = (MultiColumnStatsData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->column_count != argc)
+        return;
+
+    for (int i = 0; i < argc; i++) {
+        int value_type = sqlite3_value_type(argv[i]);
+        if ((value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT) || ctx->counts[i] == 0)
+            continue;
+        if (--ctx->counts[i] == 0) {
+            ctx->shifts[i] = 0.0;
+            ctx->means[i] = 0.0;
+            ctx->m2s[i] = 0.0;
+            continue;
+        }
+        double value = sqlite3_value_double(argv[i]) - ctx->shifts[i];
+        double delta = value - ctx->means[i];
+        ctx->means[i] -= delta / (double)ctx->counts[i];
+        ctx->m2s[i] -= delta * (value - ctx->means[i]);
+        if (ctx->m2s[i] < 0.0)
+            ctx->m2s[i] = 0.0;
+    }
+}
+
+static void stddev_cols_value(sqlite3_context *context) { stddev_cols_helper(context); }
+static void stddev_cols_final(sqlite3_context *context) { stddev_cols_helper(context); }
+
+/**
+ * @brief The "step" function of the order statistics functions.
+ *
+ * The first argument is the value; any further arguments are the requested fractions,
+ * which must be between 0 and 1 and the same for every row. Without fractions
+ * (`median`), the fraction is 0.5.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values.
+ */
+static void quantile_step(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    if (argc < 1) {
+        sqlite3_result_error(context, "Order statistics functions require at least 1 argument", -1);
+        return;
+    }
+
+    int fraction_count = argc > 1 ? argc - 1 : 1;
+    size_t size = sizeof(QuantileData) + (size_t)fraction_count * (sizeof(double) + 2 * sizeof(size_t));
+    QuantileData *ctx = (QuantileData *)sqlite3_aggregate_context(context, (int)size);
+    if (!ctx) {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    // Lay out the arrays behind the header on the first call.
+    if (ctx->fraction_count == 0) {
+        ctx->fraction_count = fraction_count;
+        ctx->fractions = (double *)(ctx + 1);
+        ctx->ranks = (size_t *)(ctx->fractions + fraction_count);
+        ctx->fractions[0] = 0.5;
+        ctx->fractions_known = argc == 1;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        double fraction;
+        if (!read_fraction_argument(context, argv[i], &fraction))
+            return;
+        if (ctx->fractions_known && fraction != ctx->fractions[i - 1]) {
+            sqlite3_result_error(context, "Fraction argument must be the same for all rows", -1);
+            return;
+        }
+        ctx->fractions[i - 1] = fraction;
+    }
+    ctx->fractions_known = 1;
+
+    int value_type = check_numeric_argument(context, argv[0]);
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
+        return;
+
+    // Never compact: a median, quantile or deviation must come from the exact values.
+    if (ctx->ring.count >= ctx->ring.capacity) {
+        int rc = grow_circular_buffer(&ctx->ring, (StatsBufferPool *)sqlite3_user_data(context), 0);
+        if (rc == SQLITE_TOOBIG) {
+            sqlite3_result_error(context, "Order statistics buffer exceeds max_buffer_size", -1);
+            return;
+        } else if (rc != SQLITE_OK) {
+            sqlite3_result_error_nomem(context);
+            return;
+        }
+    }
+    add_to_circular_buffer(&ctx->ring, sqlite3_value_double(argv[0]));
+}
+
+/**
+ * @brief The "step" function of `quantiles`, which requires at least one fraction.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values.
+ */
+static void quantiles_step(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    if (argc < 2) {
+        sqlite3_result_error(context, "quantiles requires at least 2 arguments", -1);
+        return;
+    }
+    quantile_step(context, argc, argv);
+}
+
+/**
+ * @brief The "inverse" function of the order statistics functions.
+ *
+ * SQLite removes rows from a window frame in the order it added them, so the
+ * departing value is always the oldest one in the buffer.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values of the row leaving the window.
+ */
+static void quantile_inverse(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    QuantileData *ctx = (QuantileData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->ring.count == 0)
+        return;
+
+    int value_type = sqlite3_value_type(argv[0]);
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
+        return;
+    remove_from_circular_buffer(&ctx->ring);
+}
+
+static void percentile_cont_value(sqlite3_context *context) { quantile_result_helper(context, QUANTILE_CONTINUOUS, 0, 0); }
+static void percentile_cont_final(sqlite3_context *context) { quantile_result_helper(context, QUANTILE_CONTINUOUS, 0, 1); }
+static void percentile_disc_value(sqlite3_context *context) { quantile_result_helper(context, QUANTILE_DISCRETE, 0, 0); }
+static void percentile_disc_final(sqlite3_context *context) { quantile_result_helper(context, QUANTILE_DISCRETE, 0, 1); }
+static void quantiles_value(sqlite3_context *context) { quantile_result_helper(context, QUANTILE_CONTINUOUS, 1, 0); }
+static void quantiles_final(sqlite3_context *context) { quantile_result_helper(context, QUANTILE_CONTINUOUS, 1, 1); }
+
+/**
+ * @brief The "step" function of `rolling_median` and `rolling_quantile`.
+ *
+ * Inserts the value into the frame's order statistic tree in O(log n). The optional
+ * second argument is the fraction, which must be the same for every row; without
+ * it (`rolling_median`), the fraction is 0.5.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values.
+ */
+static void rolling_quantile_step(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    if (argc != 1 && argc != 2) {
+        sqlite3_result_error(context, "Rolling quantile functions require 1 or 2 arguments", -1);
+        return;
+    }
+
+    RollingQuantileData *ctx = (RollingQuantileData *)sqlite3_aggregate_context(context, sizeof(RollingQuantileData));
+    if (!ctx) {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    double fraction = 0.5;
+    if (argc == 2 && !read_fraction_argument(context, argv[1], &fraction))
+        return;
+    if (ctx->fraction_known && fraction != ctx->fraction) {
+        sqlite3_result_error(context, "Fraction argument must be the same for all rows", -1);
+        return;
+    }
+    ctx->fraction = fraction;
+    ctx->fraction_known = 1;
+
+    int value_type = check_numeric_argument(context, argv[0]);
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
+        return;
+
+    int rc = insert_into_tree(&ctx->tree, sqlite3_value_double(argv[0]), (const StatsBufferPool *)sqlite3_user_data(context));
+    if (rc == SQLITE_TOOBIG)
+        sqlite3_result_error(context, "Order statistics buffer exceeds max_buffer_size", -1);
+    else if (rc != SQLITE_OK)
+        sqlite3_result_error_nomem(context);
+}
+
+/**
+ * @brief The "inverse" function of `rolling_median` and `rolling_quantile`.
+ *
+ * Deletes the departing value, which SQLite passes in, from the tree in O(log n).
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values of the row leaving the window.
+ */
+static void rolling_quantile_inverse(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    RollingQuantileData *ctx = (RollingQuantileData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx)
+        return;
+
+    int value_type = sqlite3_value_type(argv[0]);
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
+        return;
+    remove_from_tree(&ctx->tree, sqlite3_value_double(argv[0]));
+}
+
+/**
+ * @brief The "value" function of `rolling_median` and `rolling_quantile`.
+ * @param context The SQLite function context.
+ */
+static void rolling_quantile_value(sqlite3_context *context) {
+    RollingQuantileData *ctx = (RollingQuantileData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || !ctx->tree.root) {
+        sqlite3_result_null(context);
+        return;
+    }
+
+    sqlite3_result_double(context, get_tree_quantile(&ctx->tree, ctx->fraction));
+}
+
+/**
+ * @brief The "final" function of `rolling_median` and `rolling_quantile`.
+ *
+ * Returns the result like `rolling_quantile_value` and then frees the tree.
+ * @param context The SQLite function context.
+ */
+static void rolling_quantile_final(sqlite3_context *context) {
+    rolling_quantile_value(context);
+    RollingQuantileData *ctx = (RollingQuantileData *)sqlite3_aggregate_context(context, 0);
+    if (ctx)
+        free_tree(&ctx->tree);
+}
+
+/**
+ * @brief The "step" function of `approx_median`, `approx_quantile` and `quantile_sketch`.
+ *
+ * Counts the value in its sketch bucket. The optional second argument is the
+ * fraction of `approx_quantile`, which must be the same for every row.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values.
+ */
+static void sketch_step(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    if (argc != 1 && argc != 2) {
+        sqlite3_result_error(context, "Quantile sketch functions require 1 or 2 arguments", -1);
+        return;
+    }
+
+    QuantileSketchData *ctx = (QuantileSketchData *)sqlite3_aggregate_context(context, sizeof(QuantileSketchData));
+    if (!ctx) {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    double fraction = 0.5;
+    if (argc == 2 && !read_fraction_argument(context, argv[1], &fraction))
+        return;
+    if (ctx->fraction_known && fraction != ctx->fraction) {
+        sqlite3_result_error(context, "Fraction argument must be the same for all rows", -1);
+        return;
+    }
+    ctx->fraction = fraction;
+    ctx->fraction_known = 1;
+
+    int value_type = check_numeric_argument(context, argv[0]);
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
+        return;
+
+    if (add_to_sketch(ctx, sqlite3_value_double(argv[0]), 1) != SQLITE_OK)
+        sqlite3_result_error_nomem(context);
+}
+
+/**
+ * @brief The "inverse" function of `approx_median`, `approx_quantile` and `quantile_sketch`.
+ *
+ * Uncounts the departing value from its bucket, which is exact.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values of the row leaving the window.
+ */
+static void sketch_inverse(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    QuantileSketchData *ctx = (QuantileSketchData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx)
+        return;
+
+    int value_type = sqlite3_value_type(argv[0]);
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
+        return;
+    add_to_sketch(ctx, sqlite3_value_double(argv[0]), -1);
+}
+
+/**
+ * @brief The "step" function of `quantile_sketch_merge`, adding up serialized sketches.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values.
+ */
+static void sketch_merge_step(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    if (argc != 1) {
+        sqlite3_result_error(context, "Statistics functions require exactly 1 argument", -1);
+        return;
+    }
+
+    QuantileSketchData *ctx = (QuantileSketchData *)sqlite3_aggregate_context(context, sizeof(QuantileSketchData));
+    if (!ctx) {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL)
+        return; // Ignore NULLs.
+
+    int rc = SQLITE_ERROR;
+    if (sqlite3_value_type(argv[0]) == SQLITE_BLOB)
+        rc = merge_quantile_sketch(ctx, sqlite3_value_blob(argv[0]), sqlite3_value_bytes(argv[0]), 1);
+    if (rc == SQLITE_NOMEM)
+        sqlite3_result_error_nomem(context);
+    else if (rc != SQLITE_OK)
+        sqlite3_result_error(context, "Invalid data type, expected a quantile sketch BLOB.", -1);
+}
+
+/**
+ * @brief The "inverse" function of `quantile_sketch_merge`, subtracting a departing sketch.
+ *
+ * Bucket counts subtract exactly, so rolling quantiles over pre-aggregated
+ * bucket sketches cost O(sketch size) per row.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values of the row leaving the window.
+ */
+static void sketch_merge_inverse(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    QuantileSketchData *ctx = (QuantileSketchData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx)
+        return;
+
+    // Sketches that were ignored or rejected on entry are ignored here as well.
+    if (sqlite3_value_type(argv[0]) == SQLITE_BLOB)
+        merge_quantile_sketch(ctx, sqlite3_value_blob(argv[0]), sqlite3_value_bytes(argv[0]), -1);
+}
+
+static void approx_quantile_value(sqlite3_context *context) { sketch_result_helper(context, 0, 0); }
+static void approx_quantile_final(sqlite3_context *context) { sketch_result_helper(context, 0, 1); }
+static void sketch_state_value(sqlite3_context *context) { sketch_result_helper(context, 1, 0); }
+static void sketch_state_final(sqlite3_context *context) { sketch_result_helper(context, 1, 1); }
+
+/**
+ * @brief The scalar `quantile_sketch_finalize(sketch, p)`, estimating a quantile from a serialized sketch.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values.
+ */
+static void quantile_sketch_finalize(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    double fraction;
+    if (!read_fraction_argument(context, argv[1], &fraction))
+        return;
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL) {
+        sqlite3_result_null(context);
+        return;
+    }
+
+    QuantileSketchData sketch;
+    memset(&sketch, 0, sizeof(sketch));
+    int rc = SQLITE_ERROR;
+    if (sqlite3_value_type(argv[0]) == SQLITE_BLOB)
+        rc = merge_quantile_sketch(&sketch, sqlite3_value_blob(argv[0]), sqlite3_value_bytes(argv[0]), 1);
+    if (rc == SQLITE_NOMEM)
+        sqlite3_result_error_nomem(context);
+    else if (rc != SQLITE_OK)
+        sqlite3_result_error(context, "Invalid data type, expected a quantile sketch BLOB.", -1);
+    else if (sketch.negative.total + sketch.zero_count + sketch.positive.total <= 0)
+        sqlite3_result_null(context);
+    else
+        sqlite3_result_double(context, get_sketch_quantile(&sketch, fraction));
+    free_quantile_sketch(&sketch);
+}
+
+/**
+ * @brief The "step" function of `rolling_min`, `rolling_max` and `rolling_range`.
+ *
+ * Appends the value to both monotonic deques, first dropping the candidates it
+ * supersedes from their tails. This is amortized O(1) per row.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values.
+ */
+static void rolling_extrema_step(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    if (argc != 1) {
+        sqlite3_result_error(context, "Statistics functions require exactly 1 argument", -1);
+        return;
+    }
+
+    RollingExtremaData *ctx = (RollingExtremaData *)sqlite3_aggregate_context(context, sizeof(RollingExtremaData));
+    if (!ctx) {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    int value_type = check_numeric_argument(context, argv[0]);
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
+        return;
+
+    StatsBufferPool *pool = (StatsBufferPool *)sqlite3_user_data(context);
+    double value = sqlite3_value_double(argv[0]);
+    int rc = push_to_monotonic_deque(&ctx->min_deque, value, 0, pool);
+    if (rc == SQLITE_OK)
+        rc = push_to_monotonic_deque(&ctx->max_deque, value, 1, pool);
+    if (rc == SQLITE_TOOBIG)
+        sqlite3_result_error(context, "Frame buffer exceeds max_buffer_size", -1);
+    else if (rc != SQLITE_OK)
+        sqlite3_result_error_nomem(context);
+    else
+        ctx->count++;
+}
+
+/**
+ * @brief The "inverse" function of `rolling_min`, `rolling_max` and `rolling_range`.
+ *
+ * SQLite removes rows in the order it added them, so the departing value is the
+ * oldest of the frame: if it is still a candidate, it is at the head of its deque.
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values of the row leaving the window.
+ */
+static void rolling_extrema_inverse(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    RollingExtremaData *ctx = (RollingExtremaData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->count == 0)
+        return;
+
+    int value_type = sqlite3_value_type(argv[0]);
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
+        return;
+
+    double value = sqlite3_value_double(argv[0]);
+    if (ctx->min_deque.count > 0 && get_circular_value(&ctx->min_deque, 0) == value)
+        remove_from_circular_buffer(&ctx->min_deque);
+    if (ctx->max_deque.count > 0 && get_circular_value(&ctx->max_deque, 0) == value)
+        remove_from_circular_buffer(&ctx->max_deque);
+    ctx->count--;
+}
+
+static void rolling_min_value(sqlite3_context *context) { rolling_extrema_helper(context, EXTREMA_MIN, 0); }
+static void rolling_min_final(sqlite3_context *context) { rolling_extrema_helper(context, EXTREMA_MIN, 1); }
+static void rolling_max_value(sqlite3_context *context) { rolling_extrema_helper(context, EXTREMA_MAX, 0); }
+static void rolling_max_final(sqlite3_context *context) { rolling_extrema_helper(context, EXTREMA_MAX, 1); }
+static void rolling_range_value(sqlite3_context *context) { rolling_extrema_helper(context, EXTREMA_RANGE, 0); }
+static void rolling_range_final(sqlite3_context *context) { rolling_extrema_helper(context, EXTREMA_RANGE, 1); }
+
+static void mad_value(sqlite3_context *context) { mad_result_helper(context, 1.0, 0); }
+static void mad_final(sqlite3_context *context) { mad_result_helper(context, 1.0, 1); }
+static void mad_normal_value(sqlite3_context *context) { mad_result_helper(context, MAD_NORMAL_SCALE, 0); }
+static void mad_normal_final(sqlite3_context *context) { mad_result_helper(context, MAD_NORMAL_SCALE, 1); }
+static void rolling_mad_value(sqlite3_context *context) { rolling_mad_helper(context, 1.0, 0); }
+static void rolling_mad_final(sqlite3_context *context) { rolling_mad_helper(context, 1.0, 1); }
+static void rolling_mad_normal_value(sqlite3_context *context) { rolling_mad_helper(context, MAD_NORMAL_SCALE, 0); }
+static void rolling_mad_normal_final(sqlite3_context *context) { rolling_mad_helper(context, MAD_NORMAL_SCALE, 1); }
+
+// --- Helper Functions ---
+
+/**
+ * @brief Checks that an argument is numeric or NULL.
+ *
+ * For any other type an error is reported to SQLite.
+ * @param context The SQLite function context.
+ * @param value The argument to check.
+ * @return The type of the value (SQLITE_INTEGER, SQLITE_FLOAT or SQLITE_NULL), or 0 if an error was reported.
+ */
+static int check_numeric_argument(sqlite3_context *context, sqlite3_value *value) {
+    int value_type = sqlite3_value_type(value);
+    if (value_type != SQLITE_NULL && value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT) {
+        sqlite3_result_error(context, "Invalid data type, expected numeric value.", -1);
+        return 0;
+    }
+    return value_type;
+}
+
+/**
+ * @brief Adds a value to the accumulator using Welford's online update on shifted data.
+ * @param data The window statistics data structure.
+ * @param value The value to add.
+ */
+static void add_to_window_stats(WindowStatsData *data, double value) {
+    if (data->float_count == 0)
+        data->shift = value;
+    value -= data->shift;
+    data->count++;
+    data->float_count++;
+    double delta = value - data->mean;
+    data->mean += delta / (double)data->float_count;
+    data->m2 += delta * (value - data->mean);
+}
+
+/**
+ * @brief Removes a value from the accumulator by reversing Welford's update.
+ *
+ * When the last value is removed the accumulator is reset exactly, so rounding
+ * error cannot carry over into the next run of values. `m2` is clamped at zero,
+ * as rounding in the reverse update could otherwise make it slightly negative.
+ * @param data The window statistics data structure.
+ * @param value The value to remove. It must have been added previously.
+ */
+static void remove_from_window_stats(WindowStatsData *data, double value) {
+    if (data->float_count == 0)
+        return;
+    data->count--;
+    if (--data->float_count == 0) {
+        data->shift = 0.0;
+        data->mean = 0.0;
+        data->m2 = 0.0;
+#if STATS_HAVE_INT128
+        if (data->count == 0)
+            data->int_overflow = 0;
+#endif
+        return;
+    }
+    value -= data->shift;
+    double delta = value - data->mean;
+    data->mean -= delta / (double)data->float_count;
+    data->m2 -= delta * (value - data->mean);
+    if (data->m2 < 0.0)
+        data->m2 = 0.0;
+}
+
+#if STATS_HAVE_INT128
+/**
+ * @brief Computes the mean and m2 of the exact INTEGER partition.
+ *
+ * `m2` is derived from the exact numerator `n * sum_sq - sum^2`, so the only
+ * rounding is the final conversion to double. If the numerator does not fit in
+ * 128 bits, it falls back to long double arithmetic.
+ * @param data The window statistics data structure.
+ * @param mean Receives the mean of the INTEGER values.
+ * @param m2 Receives the sum of squared deviations of the INTEGER values.
+ */
+static void get_integer_moments(const WindowStatsData *data, double *mean, double *m2) {
+    size_t n = data->count - data->float_count;
+    __int128 scaled_sum_sq, sum_squared, numerator;
+    *mean = (double)((long double)data->int_shift + (long double)data->int_sum / (long double)n);
+    if (!__builtin_mul_overflow(data->int_sum_sq, (__int128)n, &scaled_sum_sq) &&
+        !__builtin_mul_overflow(data->int_sum, data->int_sum, &sum_squared) &&
+        !__builtin_sub_overflow(scaled_sum_sq, sum_squared, &numerator)) {
+        *m2 = (double)((long double)numerator / (long double)n);
+    } else {
+        long double sum = (long double)data->int_sum;
+        *m2 = (double)((long double)data->int_sum_sq - sum * sum / (long double)n);
+    }
+}
+
+/**
+ * @brief Folds the exact INTEGER partition into the Welford engine.
+ *
+ * Used when the exact sum of squares would overflow. Afterwards all values are
+ * held by the Welford engine and `int_overflow` is set.
+ * @param data The window statistics data structure.
+ */
+static void fold_integers_into_window_stats(WindowStatsData *data) {
+    size_t int_count = data->count - data->float_count;
+    if (int_count > 0) {
+        double int_mean, int_m2;
+        get_integer_moments(data, &int_mean, &int_m2);
+        data->count -= int_count;
+        add_moments_to_window_stats(data, int_count, int_mean, 0.0, int_m2);
+    }
+    data->int_shift = 0;
+    data->int_sum = 0;
+    data->int_sum_sq = 0;
+    data->int_overflow = 1;
+}
+#endif
+
+/**
+ * @brief Adds an INTEGER value to the exact partition of the accumulator.
+ *
+ * Without 128-bit integer support, or after the exact sums have overflowed, the
+ * value is passed to the Welford engine instead.
+ * @param data The window statistics data structure.
+ * @param value The value to add.
+ */
+static void add_integer_to_window_stats(WindowStatsData *data, sqlite3_int64 value) {
+#if STATS_HAVE_INT128
+    if (!data->int_overflow) {
+        if (data->count == data->float_count)
+            data->int_shift = value;
+        __int128 shifted = (__int128)value - data->int_shift, square, new_sum_sq;
+        if (!__builtin_mul_overflow(shifted, shifted, &square) && !__builtin_add_overflow(data->int_sum_sq, square, &new_sum_sq)) {
+            data->int_sum += shifted;
+            data->int_sum_sq = new_sum_sq;
+            data->count++;
+            return;
+        }
+        fold_integers_into_window_stats(data);
+    }
+#endif
+    add_to_window_stats(data, (double)value);
+}
+
+/**
+ * @brief Removes an INTEGER value from the accumulator.
+ * @param data The window statistics data structure.
+ * @param value The value to remove. It must have been added previously.
+ */
+static void remove_integer_from_window_stats(WindowStatsData *data, sqlite3_int64 value) {
+#if STATS_HAVE_INT128
+    if (!data->int_overflow) {
+        if (data->count == data->float_count)
+            return;
+        __int128 shifted = (__int128)value - data->int_shift;
+        data->int_sum -= shifted;
+        data->int_sum_sq -= shifted * shifted;
+        data->count--;
+        return;
+    }
+#endif
+    remove_from_window_stats(data, (double)value);
+}
+
+/**
+ * @brief Combines both partitions of the accumulator into an overall mean and m2.
+ * @param data The window statistics data structure. Must hold at least one value.
+ * @param mean Receives the mean of all values.
+ * @param m2 Receives the sum of squared deviations from the mean of all values.
+ */
+static void get_window_stats_moments(const WindowStatsData *data, double *mean, double *m2) {
+    *mean = data->shift + data->mean;
+    *m2 = data->m2;
+#if STATS_HAVE_INT128
+    size_t int_count = data->count - data->float_count;
+    if (int_count == 0)
+        return;
+    double int_mean, int_m2;
+    get_integer_moments(data, &int_mean, &int_m2);
+    if (data->float_count == 0) {
+        *mean = int_mean;
+        *m2 = int_m2;
+        return;
+    }
+    // Chan et al. parallel combination of the two partitions.
+    double n_a = (double)data->float_count, n_b = (double)int_count, n = n_a + n_b;
+    double delta = (int_mean - data->shift) - data->mean;
+    *mean += delta * n_b / n;
+    *m2 += int_m2 + delta * delta * n_a * n_b / n;
+#endif
+}
+
+/**
+ * @brief Adds a whole set of values, given by its moments, to the Welford engine.
+ *
+ * Uses the parallel combination formula of Chan et al. The set is described like
+ * the Welford engine itself: `mean` is the mean of its values shifted by `shift`.
+ * @param data The window statistics data structure.
+ * @param n The number of values in the set.
+ * @param shift The offset the set's mean is relative to.
+ * @param mean The mean of the set's values minus `shift`.
+ * @param m2 The sum of squared deviations of the set's values from their mean.
+ */
+static void add_moments_to_window_stats(WindowStatsData *data, size_t n, double shift, double mean, double m2) {
+    if (n == 0)
+        return;
+    if (data->float_count == 0) {
+        data->shift = shift;
+        data->mean = mean;
+        data->m2 = m2;
+    } else {
+        double n_a = (double)data->float_count, n_b = (double)n, n_ab = n_a + n_b;
+        double delta = (shift - data->shift) + (mean - data->mean);
+        data->mean += delta * n_b / n_ab;
+        data->m2 += m2 + delta * delta * n_a * n_b / n_ab;
+    }
+    data->count += n;
+    data->float_count += n;
+}
+
+/**
+ * @brief Removes a set of values, given by its moments, from the Welford engine.
+ *
+ * Reverses `add_moments_to_window_stats`. Removing as many values as the engine
+ * holds resets it exactly.
+ * @param data The window statistics data structure.
+ * @param n The number of values in the set.
+ * @param shift The offset the set's mean is relative to.
+ * @param mean The mean of the set's values minus `shift`.
+ * @param m2 The sum of squared deviations of the set's values from their mean.
+ */
+static void remove_moments_from_window_stats(WindowStatsData *data, size_t n, double shift, double mean, double m2) {
+    if (n == 0)
+        return;
+    if (n >= data->float_count) {
+        data->count -= data->float_count;
+        data->float_count = 0;
+        data->shift = 0.0;
+        data->mean = 0.0;
+        data->m2 = 0.0;
+        return;
+    }
+    double n_ab = (double)data->float_count, n_b = (double)n, n_a = n_ab - n_b;
+    double mean_b = (shift - data->shift) + mean;
+    double mean_a = (n_ab * data->mean - n_b * mean_b) / n_a;
+    double delta = mean_b - mean_a;
+    data->mean = mean_a;
+    data->m2 -= m2 + delta * delta * n_a * n_b / n_ab;
+    if (data->m2 < 0.0)
+        data->m2 = 0.0;
+    data->count -= n;
+    data->float_count -= n;
+}
+
+#if STATS_HAVE_INT128
+/**
+ * @brief Re-expresses exact INTEGER sums relative to a different shift.
+ *
+ * Sums of `v - old_shift` become sums of `v - new_shift`, i.e. every value moves by
+ * `k = old_shift - new_shift`.
+ * @param n The number of values.
+ * @param k The difference between the old and the new shift.
+ * @param sum The sum of the shifted values, updated in place.
+ * @param sum_sq The sum of the squares of the shifted values, updated in place.
+ * @return 0 on success, non-zero if the result does not fit in 128 bits (the sums are then unchanged).
+ */
+static int rebase_integer_sums(size_t n, __int128 k, __int128 *sum, __int128 *sum_sq) {
+    __int128 n_k, new_sum, two_k_sum, n_k_k, new_sum_sq;
+    if (__builtin_mul_overflow((__int128)n, k, &n_k) || __builtin_add_overflow(*sum, n_k, &new_sum) ||
+        __builtin_mul_overflow(*sum, 2 * k, &two_k_sum) || __builtin_mul_overflow(n_k, k, &n_k_k) ||
+        __builtin_add_overflow(*sum_sq, two_k_sum, &new_sum_sq) || __builtin_add_overflow(new_sum_sq, n_k_k, &new_sum_sq))
+        return 1;
+    *sum = new_sum;
+    *sum_sq = new_sum_sq;
+    return 0;
+}
+#endif
+
+/**
+ * @brief Merges the values summarized by another accumulator into this one.
+ *
+ * The Welford engines are combined with the parallel formula of Chan et al. The
+ * exact INTEGER partitions are combined exactly after bringing them to a common
+ * shift; if that would overflow, both are folded into the Welford engine.
+ * @param data The window statistics data structure to merge into.
+ * @param other The accumulator to merge.
+ */
+static void merge_window_stats(WindowStatsData *data, const WindowStatsData *other) {
+    add_moments_to_window_stats(data, other->float_count, other->shift, other->mean, other->m2);
+#if STATS_HAVE_INT128
+    size_t other_int_count = other->count - other->float_count;
+    if (other_int_count == 0)
+        return;
+    if (!data->int_overflow) {
+        if (data->count == data->float_count) {
+            data->int_shift = other->int_shift;
+            data->int_sum = other->int_sum;
+            data->int_sum_sq = other->int_sum_sq;
+            data->count += other_int_count;
+            return;
+        }
+        __int128 sum = other->int_sum, sum_sq = other->int_sum_sq, new_sum_sq;
+        if (!rebase_integer_sums(other_int_count, (__int128)other->int_shift - data->int_shift, &sum, &sum_sq) &&
+            !__builtin_add_overflow(data->int_sum_sq, sum_sq, &new_sum_sq)) {
+            data->int_sum += sum;
+            data->int_sum_sq = new_sum_sq;
+            data->count += other_int_count;
+            return;
+        }
+        fold_integers_into_window_stats(data);
+    }
+    double int_mean, int_m2;
+    get_integer_moments(other, &int_mean, &int_m2);
+    add_moments_to_window_stats(data, other_int_count, int_mean, 0.0, int_m2);
+#endif
+}
+
+/**
+ * @brief Removes the values summarized by another accumulator from this one.
+ *
+ * Reverses `merge_window_stats`. `other` must have been merged previously. While
+ * the exact INTEGER partition has not overflowed, it is brought to the common
+ * shift again (which cannot overflow, as it already succeeded when merging) and
+ * subtracted exactly.
+ * @param data The window statistics data structure to remove from.
+ * @param other The accumulator to remove.
+ */
+static void unmerge_window_stats(WindowStatsData *data, const WindowStatsData *other) {
+    if (other->count >= data->count) {
+        memset(data, 0, sizeof(*data));
+        return;
+    }
+    remove_moments_from_window_stats(data, other->float_count, other->shift, other->mean, other->m2);
+#if STATS_HAVE_INT128
+    size_t other_int_count = other->count - other->float_count;
+    if (other_int_count == 0)
+        return;
+    if (!data->int_overflow) {
+        __int128 sum = other->int_sum, sum_sq = other->int_sum_sq;
+        if (!rebase_integer_sums(other_int_count, (__int128)other->int_shift - data->int_shift, &sum, &sum_sq)) {
+            data->int_sum -= sum;
+            data->int_sum_sq -= sum_sq;
+            data->count -= other_int_count;
+            return;
+        }
+    }
+    double int_mean, int_m2;
+    get_integer_moments(other, &int_mean, &int_m2);
+    remove_moments_from_window_stats(data, other_int_count, int_mean, 0.0, int_m2);
+#endif
+}
+
+/**
+ * @brief Writes an unsigned 64-bit integer in big-endian byte order.
+ * @param buffer The destination, at least 8 bytes.
+ * @param value The value to write.
+ */
+static void put_uint64(unsigned char *buffer, sqlite3_uint64 value) {
+    for (int i = 7; i >= 0; i--) {
+        buffer[i] = (unsigned char)(value & 0xff);
+        value >>= 8;
+    }
+}
+
+/**
+ * @brief Reads an unsigned 64-bit integer in big-endian byte order.
+ * @param buffer The source, at least 8 bytes.
+ * @return The value read.
+ */
+static sqlite3_uint64 get_uint64(const unsigned char *buffer) {
+    sqlite3_uint64 value = 0;
+    for (int i = 0; i < 8; i++)
+        value = (value << 8) | buffer[i];
+    return value;
+}
+
+/**
+ * @brief Writes an IEEE 754 double as its bit pattern in big-endian byte order.
+ * @param buffer The destination, at least 8 bytes.
+ * @param value The value to write.
+ */
+static void put_double(unsigned char *buffer, double value) {
+    sqlite3_uint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_uint64(buffer, bits);
+}
+
+/**
+ * @brief Reads an IEEE 754 double written by `put_double`.
+ * @param buffer The source, at least 8 bytes.
+ * @return The value read.
+ */
+static double get_double(const unsigned char *buffer) {
+    sqlite3_uint64 bits = get_uint64(buffer);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Serializes an accumulator into a compact, endian-portable BLOB.
+ *
+ * Layout (all multi-byte fields big-endian):
+ *   - byte 0: format version (`STATS_STATE_VERSION`)
+ *   - byte 1: flags; bit 0 = Welford section present, bit 1 = INTEGER section present,
+ *     bit 2 = minimum/maximum section present (written by `serialize_summary_stats`)
+ *   - Welford section: count (u64), shift, mean, m2 (IEEE 754 doubles)
+ *   - INTEGER section: count (u64), shift (i64), sum and sum of squares (i128 each, high word first)
+ *   - minimum/maximum section: min, max (IEEE 754 doubles; NAN if unknown)
+ * @param data The accumulator to serialize.
+ * @param buffer The destination, at least `STATS_STATE_MAX_SIZE` bytes.
+ * @return The number of bytes written.
+ */
+static size_t serialize_window_stats(const WindowStatsData *data, unsigned char *buffer) {
+    size_t size = 2;
+    buffer[0] = STATS_STATE_VERSION;
+    buffer[1] = 0;
+    if (data->float_count > 0) {
+        buffer[1] |= 0x01;
+        put_uint64(buffer + size, data->float_count);
+        put_double(buffer + size + 8, data->shift);
+        put_double(buffer + size + 16, data->mean);
+        put_double(buffer + size + 24, data->m2);
+        size += 32;
+    }
+#if STATS_HAVE_INT128
+    size_t int_count = data->count - data->float_count;
+    if (int_count > 0) {
+        buffer[1] |= 0x02;
+        put_uint64(buffer + size, int_count);
+        put_uint64(buffer + size + 8, (sqlite3_uint64)data->int_shift);
+        put_uint64(buffer + size + 16, (sqlite3_uint64)((unsigned __int128)data->int_sum >> 64));
+        put_uint64(buffer + size + 24, (sqlite3_uint64)data->int_sum);
+        put_uint64(buffer + size + 32, (sqlite3_uint64)((unsigned __int128)data->int_sum_sq >> 64));
+        put_uint64(buffer + size + 40, (sqlite3_uint64)data->int_sum_sq);
+        size += 48;
+    }
+#endif
+    return size;
+}
+
+/**
+ * @brief Deserializes a BLOB written by `serialize_window_stats`.
+ *
+ * Builds without 128-bit integer support fold a serialized INTEGER section into
+ * the Welford engine using long double arithmetic. A minimum/maximum section is
+ * accepted but not read (see `deserialize_summary_stats`).
+ * @param buffer The serialized state.
+ * @param size The size of the serialized state in bytes.
+ * @param data Receives the accumulator.
+ * @return SQLITE_OK on success, SQLITE_ERROR if the BLOB is not a valid state.
+ */
+static int deserialize_window_stats(const unsigned char *buffer, int size, WindowStatsData *data) {
+    memset(data, 0, sizeof(*data));
+    if (!buffer || size < 2 || buffer[0] != STATS_STATE_VERSION || (buffer[1] & ~0x07) != 0)
+        return SQLITE_ERROR;
+    int expected = 2 + ((buffer[1] & 0x01) ? 32 : 0) + ((buffer[1] & 0x02) ? 48 : 0) + ((buffer[1] & 0x04) ? STATS_STATE_MINMAX_SIZE : 0);
+    if (size != expected)
+        return SQLITE_ERROR;
+
+    const unsigned char *p = buffer + 2;
+    if (buffer[1] & 0x01) {
+        data->float_count = (size_t)get_uint64(p);
+        data->count = data->float_count;
+        data->shift = get_double(p + 8);
+        data->mean = get_double(p + 16);
+        data->m2 = get_double(p + 24);
+        p += 32;
+    }
+    if (buffer[1] & 0x02) {
+        size_t int_count = (size_t)get_uint64(p);
+        sqlite3_int64 int_shift = (sqlite3_int64)get_uint64(p + 8);
+#if STATS_HAVE_INT128
+        data->int_shift = int_shift;
+        data->int_sum = (__int128)(((unsigned __int128)get_uint64(p + 16) << 64) | get_uint64(p + 24));
+        data->int_sum_sq = (__int128)(((unsigned __int128)get_uint64(p + 32) << 64) | get_uint64(p + 40));
+        data->count += int_count;
+#else
+        long double two_64 = 18446744073709551616.0L;
+        long double sum = (long double)(sqlite3_int64)get_uint64(p + 16) * two_64 + (long double)get_uint64(p + 24);
+        long double sum_sq = (long double)(sqlite3_int64)get_uint64(p + 32) * two_64 + (long double)get_uint64(p + 40);
+        long double mean = sum / (long double)int_count;
+        add_moments_to_window_stats(data, int_count, (double)((long double)int_shift + mean), 0.0, (double)(sum_sq - sum * mean));
+#endif
+    }
+    return SQLITE_OK;
+}
+
+/**
+ * @brief Serializes a summary state: an accumulator state followed by the minimum/maximum section.
+ * @param data The summary state to serialize.
+ * @param buffer The destination, at least `STATS_STATE_MAX_SIZE + STATS_STATE_MINMAX_SIZE` bytes.
+ * @return The number of bytes written.
+ */
+static size_t serialize_summary_stats(const SummaryStatsData *data, unsigned char *buffer) {
+    size_t size = serialize_window_stats(&data->stats, buffer);
+    buffer[1] |= 0x04;
+    put_double(buffer + size, data->minmax_unknown ? NAN : data->min);
+    put_double(buffer + size + 8, data->minmax_unknown ? NAN : data->max);
+    return size + STATS_STATE_MINMAX_SIZE;
+}
+
+/**
+ * @brief Deserializes a summary state written by `serialize_summary_stats`.
+ * @param buffer The serialized state.
+ * @param size The size of the serialized state in bytes.
+ * @param data Receives the summary state.
+ * @return SQLITE_OK on success, SQLITE_ERROR if the BLOB is not a valid summary state.
+ */
+static int deserialize_summary_stats(const unsigned char *buffer, int size, SummaryStatsData *data) {
+    memset(data, 0, sizeof(*data));
+    if (deserialize_window_stats(buffer, size, &data->stats) != SQLITE_OK || !(buffer[1] & 0x04))
+        return SQLITE_ERROR;
+    data->min = get_double(buffer + size - STATS_STATE_MINMAX_SIZE);
+    data->max = get_double(buffer + size - 8);
+    return SQLITE_OK;
+}
+
+/**
+ * @brief Calculates one of the statistics reported by the `stats_summary` family.
+ * @param data The summary state.
+ * @param field The statistic to calculate.
+ * @return The statistic, or NAN if it is undefined for the data.
+ */
+static double calculate_summary_field(const SummaryStatsData *data, SummaryField field) {
+    const WindowStatsData *stats = &data->stats;
+    double mean, m2;
+    if (field == SUMMARY_COUNT)
+        return (double)stats->count;
+    if (stats->count < MIN_COUNT_POPULATION)
+        return NAN;
+    get_window_stats_moments(stats, &mean, &m2);
+
+    switch (field) {
+    case SUMMARY_MEAN:
+        return mean;
+    case SUMMARY_MIN:
+        return data->minmax_unknown ? NAN : data->min;
+    case SUMMARY_MAX:
+        return data->minmax_unknown ? NAN : data->max;
+    case SUMMARY_VARIANCE_SAMP:
+        return calculate_variance_sample(stats);
+    case SUMMARY_VARIANCE_POP:
+        return calculate_variance_population(stats);
+    case SUMMARY_STDDEV_SAMP:
+        return calculate_stddev_sample(stats);
+    case SUMMARY_STDDEV_POP:
+        return calculate_stddev_population(stats);
+    case SUMMARY_STDERR:
+        // The standard error of the mean: sample standard deviation over sqrt(n).
+        return calculate_stddev_sample(stats) / sqrt((double)stats->count);
+    case SUMMARY_CV:
+        // The coefficient of variation: sample standard deviation relative to the mean.
+        return calculate_stddev_sample(stats) / mean;
+    default:
+        return NAN;
+    }
+}
+
+/**
+ * @brief Appends a double to a JSON document, using the shortest round-tripping form.
+ *
+ * Formats with SQLite's printf, which always writes '.' as the decimal point, so
+ * the document stays valid JSON whatever `LC_NUMERIC` locale the host has set. The
+ * `!` flag lifts SQLite's default limit of 16 significant digits. SQLite's conversion
+ * is not always correctly rounded for large exponents, so up to 20 digits are
+ * tried. NAN and infinite values, which JSON cannot represent, are written as `null`.
+ * @param str The string being built.
+ * @param value The value to append.
+ */
+static void append_json_double(sqlite3_str *str, double value) {
+    if (isnan(value) || isinf(value)) {
+        sqlite3_str_appendall(str, "null");
+        return;
+    }
+    char buffer[40];
+    for (int precision = 15; precision <= 20; precision++) {
+        sqlite3_snprintf((int)sizeof(buffer), buffer, "%!.*g", precision, value);
+        if (parses_back_to(buffer, value))
+            break;
+    }
+    sqlite3_str_appendall(str, buffer);
+}
+
+/**
+ * @brief Checks whether a number written by SQLite's printf parses back to a value.
+ *
+ * `strtod` expects the decimal point of the current `LC_NUMERIC` locale, so the
+ * '.' written by SQLite is replaced by it before parsing.
+ * @param text The formatted number.
+ * @param value The value it was formatted from.
+ * @return Non-zero if `text` parses to exactly `value`.
+ */
+static int parses_back_to(const char *text, double value) {
+    char buffer[48];
+    const char *point = localeconv()->decimal_point;
+    const char *dot = strchr(text, '.');
+    if (dot && point && strcmp(point, ".") != 0) {
+        size_t prefix = (size_t)(dot - text);
+        if (prefix + strlen(point) + strlen(dot + 1) >= sizeof(buffer))
+            return 0;
+        memcpy(buffer, text, prefix);
+        strcpy(buffer + prefix, point);
+        strcat(buffer, dot + 1);
+        text = buffer;
+    }
+    return strtod(text, NULL) == value;
+}
+
+/**
+ * @brief Rebuilds the accumulator of a re-summing function from its frame buffer.
+ *
+ * Uses the corrected two-pass algorithm: the mean of the shifted values is computed
+ * first, then the squared deviations from it are summed. The correction term
+ * removes the residual error of the computed mean.
+ * @param data The re-summing state to rebuild.
+ */
+static void resum_window_stats(ResumStatsData *data) {
+    WindowStatsData *stats = &data->stats;
+    memset(stats, 0, sizeof(*stats));
+    size_t n = data->ring.count;
+    if (n == 0)
+        return;
+
+    double shift = get_circular_value(&data->ring, 0);
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++)
+        sum += get_circular_value(&data->ring, i) - shift;
+    double mean = sum / (double)n;
+
+    double sum_dev = 0.0, sum_dev_sq = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double dev = (get_circular_value(&data->ring, i) - shift) - mean;
+        sum_dev += dev;
+        sum_dev_sq += dev * dev;
+    }
+
+    stats->count = n;
+    stats->float_count = n;
+    stats->shift = shift;
+    stats->mean = mean;
+    stats->m2 = sum_dev_sq - (sum_dev * sum_dev) / (double)n;
+    if (stats->m2 < 0.0)
+        stats->m2 = 0.0;
+}
+
+/**
+ * @brief Rebuilds the accumulator of a re-summing paired function from its frame buffers.
+ *
+ * The corrected two-pass algorithm of `resum_window_stats`, applied to both inputs
+ * and to their co-moment.
+ * @param data The re-summing paired state to rebuild.
+ */
+static void resum_paired_stats(PairedResumStatsData *data) {
+    PairedStatsData *stats = &data->stats;
+    memset(stats, 0, sizeof(*stats));
+    size_t n = data->ys.count;
+    if (n == 0)
+        return;
+
+    double shift_y = get_circular_value(&data->ys, 0);
+    double shift_x = get_circular_value(&data->xs, 0);
+    double sum_y = 0.0, sum_x = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        sum_y += get_circular_value(&data->ys, i) - shift_y;
+        sum_x += get_circular_value(&data->xs, i) - shift_x;
+    }
+    double mean_y = sum_y / (double)n;
+    double mean_x = sum_x / (double)n;
+
+    double sum_dev_y = 0.0, sum_dev_x = 0.0, sum_dev_sq_y = 0.0, sum_dev_sq_x = 0.0, sum_dev_xy = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double dev_y = (get_circular_value(&data->ys, i) - shift_y) - mean_y;
+        double dev_x = (get_circular_value(&data->xs, i) - shift_x) - mean_x;
+        sum_dev_y += dev_y;
+        sum_dev_x += dev_x;
+        sum_dev_sq_y += dev_y * dev_y;
+        sum_dev_sq_x += dev_x * dev_x;
+        sum_dev_xy += dev_x * dev_y;
+    }
+
+    stats->count = n;
+    stats->shift_y = shift_y;
+    stats->shift_x = shift_x;
+    stats->mean_y = mean_y;
+    stats->mean_x = mean_x;
+    stats->m2_y = sum_dev_sq_y - (sum_dev_y * sum_dev_y) / (double)n;
+    stats->m2_x = sum_dev_sq_x - (sum_dev_x * sum_dev_x) / (double)n;
+    stats->c_xy = sum_dev_xy - (sum_dev_x * sum_dev_y) / (double)n;
+    if (stats->m2_y < 0.0)
+        stats->m2_y = 0.0;
+    if (stats->m2_x < 0.0)
+        stats->m2_x = 0.0;
+}
+
+/**
+ * @brief Gets the size in bytes of one element of a circular buffer.
+ * @param ring The circular buffer.
+ * @return `sizeof(float)` for compact buffers, `sizeof(double)` otherwise.
+ */
+static size_t get_circular_element_size(const StatsRingBuffer *ring) {
+    return ring->compact ? sizeof(float) : sizeof(double);
+}
+
+/**
+ * @brief Gets a value at a logical index in the circular buffer.
+ * @param ring The circular buffer.
+ * @param logical_index The 0-based logical index from the start of the window.
+ * @return The value at the specified logical index.
+ */
+static double get_circular_value(const StatsRingBuffer *ring, size_t logical_index) {
+    size_t physical_index = (ring->head + logical_index) & (ring->capacity - 1);
+    if (ring->compact)
+        return ((const float *)ring->values)[physical_index];
+    return ((const double *)ring->values)[physical_index];
+}
+
+/**
+ * @brief Adds a new value to the end (tail) of the circular buffer.
+ * @param ring The circular buffer. It must not be full.
+ * @param value The value to add. Compact buffers round it to the nearest float.
+ */
+static void add_to_circular_buffer(StatsRingBuffer *ring, double value) {
+    if (ring->compact)
+        ((float *)ring->values)[ring->tail] = (float)value;
+    else
+        ((double *)ring->values)[ring->tail] = value;
+    ring->tail = (ring->tail + 1) & (ring->capacity - 1);
+    ring->count++;
+}
+
+/**
+ * @brief Removes a value from the beginning (head) of the circular buffer.
+ *
+ * A heap buffer that has drained to a quarter of its capacity, as happens when a
+ * long expanding frame is followed by a short one, is shrunk by half.
+ * @param ring The circular buffer.
+ * @return The value that was removed.
+ */
+static double remove_from_circular_buffer(StatsRingBuffer *ring) {
+    if (ring->count == 0)
+        return 0.0;
+    double removed_value = get_circular_value(ring, 0);
+    ring->head = (ring->head + 1) & (ring->capacity - 1);
+    ring->count--;
+    if (ring->capacity * get_circular_element_size(ring) > INITIAL_CAPACITY * sizeof(double) && ring->count <= ring->capacity / 4)
+        shrink_circular_buffer(ring);
+    return removed_value;
+}
+
+/**
+ * @brief Removes a value from the end (tail) of the circular buffer.
+ *
+ * Shrinks a drained heap buffer like `remove_from_circular_buffer`.
+ * @param ring The circular buffer.
+ * @return The value that was removed.
+ */
+static double remove_last_from_circular_buffer(StatsRingBuffer *ring) {
+    if (ring->count == 0)
+        return 0.0;
+    double removed_value = get_circular_value(ring, ring->count - 1);
+    ring->tail = (ring->tail - 1) & (ring->capacity - 1);
+    ring->count--;
+    if (ring->capacity * get_circular_element_size(ring) > INITIAL_CAPACITY * sizeof(double) && ring->count <= ring->capacity / 4)
+        shrink_circular_buffer(ring);
+    return removed_value;
+}
+
+/**
+ * @brief Grows a full circular buffer, setting it up on first use.
+ *
+ * The first call picks the element type and points the buffer at its inline region.
+ * Floats are only used where the caller allows them and the connection's
+ * `float32_buffers` setting asks for them. When the inline region is full, the values are
+ * copied in two segments to the start of a heap buffer
+ * taken from the pool (or allocated). A heap buffer is doubled in place with
+ * `sqlite3_realloc64`; the shorter of the two segments of the wrapped contents is then
+ * moved so that the values are contiguous modulo the new capacity again. From the
+ * connection's spill size on, the values are instead copied to a new file mapping;
+ * if no temporary file can be mapped, the buffer stays on the heap.
+ * @param ring The circular buffer to grow. It must be full.
+ * @param pool The connection's buffer pool, or NULL.
+ * @param allow_compact Non-zero if the values may be stored as floats. Buffers whose
+ *        values are returned as results, like those of the order statistics, pass 0.
+ * @return SQLITE_OK on success, SQLITE_TOOBIG if the grown buffer would exceed the
+ *         connection's buffer size limit, SQLITE_NOMEM on memory allocation failure.
+ */
+static int grow_circular_buffer(StatsRingBuffer *ring, StatsBufferPool *pool, int allow_compact) {
+    if (ring->capacity == 0) {
+        ring->compact = allow_compact && pool && pool->float32_buffers;
+        ring->values = ring->inline_values;
+        ring->capacity = sizeof(ring->inline_values) / get_circular_element_size(ring);
+        ring->head = 0;
+        ring->tail = 0;
+        return SQLITE_OK;
+    }
+
+    size_t element_size = get_circular_element_size(ring);
+    if (ring->values == ring->inline_values) {
+        if (!is_buffer_size_allowed(pool, INITIAL_CAPACITY * sizeof(double)))
+            return SQLITE_TOOBIG;
+        size_t new_size;
+        void *new_values = acquire_pooled_buffer(pool, INITIAL_CAPACITY * sizeof(double), &new_size);
+        if (!new_values)
+            return SQLITE_NOMEM;
+        move_circular_buffer(ring, new_values, new_size / element_size, 0, pool);
+        return SQLITE_OK;
+    }
+
+    size_t old_capacity = ring->capacity;
+    size_t new_capacity = old_capacity * 2;
+    size_t new_size = new_capacity * element_size;
+    if (!is_buffer_size_allowed(pool, new_size))
+        return SQLITE_TOOBIG;
+
+#if STATS_HAVE_MMAP
+    if (pool && pool->mmap_spill_size > 0 && new_size >= (sqlite3_uint64)pool->mmap_spill_size) {
+        void *mapped_values = map_spill_buffer(new_size);
+        if (mapped_values) {
+            move_circular_buffer(ring, mapped_values, new_capacity, 1, pool);
+            return SQLITE_OK;
+        }
+    }
+    if (ring->mapped) {
+        // A mapping cannot be resized in place; continue on the heap.
+        void *heap_values = sqlite3_malloc64(new_size);
+        if (!heap_values)
+            return SQLITE_NOMEM;
+        move_circular_buffer(ring, heap_values, new_capacity, 0, pool);
+        return SQLITE_OK;
+    }
+#endif
+
+    size_t head_length = old_capacity - ring->head; // Values from `head` to the end of the buffer.
+    size_t wrap_length = ring->count - head_length; // Values wrapped around to the start.
+    char *new_values = (char *)sqlite3_realloc64(ring->values, new_size);
+    if (!new_values)
+        return SQLITE_NOMEM;
+    ring->values = new_values;
+    ring->capacity = new_capacity;
+    if (wrap_length <= head_length) {
+        // Append the wrapped values after the old end.
+        memcpy(new_values + old_capacity * element_size, new_values, wrap_length * element_size);
+    } else {
+        // Move the values from `head` to the new end.
+        memmove(new_values + (new_capacity - head_length) * element_size, new_values + ring->head * element_size, head_length * element_size);
+        ring->head = new_capacity - head_length;
+    }
+    ring->tail = (ring->head + ring->count) & (new_capacity - 1);
+    return SQLITE_OK;
+}
+
+/**
+ * @brief Halves the capacity of a heap circular buffer holding at most a quarter of its capacity.
+ *
+ * The values are first moved to the start of the buffer, which then is truncated
+ * with `sqlite3_realloc64`. If that fails, the buffer simply keeps its capacity.
+ * File-backed buffers are kept until the group ends.
+ * @param ring The circular buffer.
+ */
+static void shrink_circular_buffer(StatsRingBuffer *ring) {
+    if (ring->mapped)
+        return;
+    size_t element_size = get_circular_element_size(ring);
+    char *values = (char *)ring->values;
+    size_t new_capacity = ring->capacity / 2;
+    size_t head_length = ring->capacity - ring->head;
+    if (head_length >= ring->count) {
+        memmove(values, values + ring->head * element_size, ring->count * element_size);
+    } else {
+        // Wrapped: both segments fit in the first quarter, below the start of the head segment.
+        size_t wrap_length = ring->count - head_length;
+        memmove(values + head_length * element_size, values, wrap_length * element_size);
+        memcpy(values, values + ring->head * element_size, head_length * element_size);
+    }
+    ring->head = 0;
+    ring->tail = ring->count & (new_capacity - 1);
+
+    void *new_values = sqlite3_realloc64(values, new_capacity * element_size);
+    if (!new_values) {
+        ring->tail = ring->count;
+        return;
+    }
+    ring->values = new_values;
+    ring->capacity = new_capacity;
+}
+
+/**
+ * @brief Releases the heap or file-backed storage of a circular buffer, if any. The element count is preserved.
+ * @param ring The circular buffer.
+ * @param pool The connection's buffer pool to return heap storage to, or NULL to free it.
+ */
+static void free_circular_buffer(StatsRingBuffer *ring, StatsBufferPool *pool) {
+#if STATS_HAVE_MMAP
+    if (ring->mapped)
+        munmap(ring->values, ring->capacity * get_circular_element_size(ring));
+    else
+#endif
+    if (ring->values && ring->values != ring->inline_values)
+        release_pooled_buffer(pool, ring->values, ring->capacity * get_circular_element_size(ring));
+    ring->values = NULL;
+    ring->capacity = 0;
+    ring->mapped = 0;
+}
+
+/**
+ * @brief Moves the contents of a circular buffer to the start of new storage and releases the old storage.
+ * @param ring The circular buffer.
+ * @param new_values The new storage, large enough for all values.
+ * @param new_capacity The capacity of the new storage in elements, a power of two.
+ * @param mapped Non-zero if the new storage is a file mapping.
+ * @param pool The connection's buffer pool, or NULL.
+ */
+static void move_circular_buffer(StatsRingBuffer *ring, void *new_values, size_t new_capacity, int mapped, StatsBufferPool *pool) {
+    size_t element_size = get_circular_element_size(ring);
+    const char *values = (const char *)ring->values;
+    size_t head_length = ring->capacity - ring->head;
+    if (head_length > ring->count)
+        head_length = ring->count;
+    memcpy(new_values, values + ring->head * element_size, head_length * element_size);
+    memcpy((char *)new_values + head_length * element_size, values, (ring->count - head_length) * element_size);
+    free_circular_buffer(ring, pool);
+    ring->values = new_values;
+    ring->capacity = new_capacity;
+    ring->mapped = mapped;
+    ring->head = 0;
+    ring->tail = ring->count & (new_capacity - 1);
+}
+
+#if STATS_HAVE_MMAP
+/**
+ * @brief Finds a writable directory for spill files.
+ *
+ * Follows SQLite's own search order on Unix: `SQLITE_TMPDIR`, `TMPDIR`, then
+ * `/var/tmp`, `/usr/tmp` and `/tmp`.
+ * @return The directory, or NULL if none is usable.
+ */
+static const char *get_spill_directory(void) {
+    const char *candidates[] = {getenv("SQLITE_TMPDIR"), getenv("TMPDIR"), "/var/tmp", "/usr/tmp", "/tmp"};
+    for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+        struct stat st;
+        if (candidates[i] && stat(candidates[i], &st) == 0 && S_ISDIR(st.st_mode) && access(candidates[i], W_OK | X_OK) == 0)
+            return candidates[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Creates a file-backed buffer for a circular buffer.
+ *
+ * The temporary file is unlinked right after creation and its descriptor closed once
+ * mapped, so it disappears with the mapping, even if the process dies. On Linux the
+ * disk space is reserved up front, so a full disk fails here instead of faulting later.
+ * The mapping is advised for sequential access, matching how frames are appended and drained.
+ * @param size The size of the buffer in bytes.
+ * @return The mapping, or NULL if no temporary file could be created and mapped.
+ */
+static void *map_spill_buffer(size_t size) {
+    const char *directory = get_spill_directory();
+    if (!directory)
+        return NULL;
+    char *path = sqlite3_mprintf("%s/sqlite_stddev_XXXXXX", directory);
+    if (!path)
+        return NULL;
+    int fd = mkstemp(path);
+    if (fd >= 0)
+        unlink(path);
+    sqlite3_free(path);
+    if (fd < 0)
+        return NULL;
+
+    void *mapping = MAP_FAILED;
+#if defined(__linux__)
+    int reserved = posix_fallocate(fd, 0, (off_t)size) == 0;
+#else
+    int reserved = ftruncate(fd, (off_t)size) == 0;
+#endif
+    if (reserved)
+        mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return NULL;
+#ifdef MADV_SEQUENTIAL
+    madvise(mapping, size, MADV_SEQUENTIAL);
+#endif
+    return mapping;
+}
+#endif
+
+/**
+ * @brief Maps a heap buffer size to its buffer pool class.
+ * @param size The size of the buffer in bytes.
+ * @return The class index, or -1 if buffers of this size are not pooled.
+ */
+static int get_buffer_pool_class(size_t size) {
+    for (int k = 0; k < BUFFER_POOL_CLASSES; k++) {
+        if (size == (INITIAL_CAPACITY * sizeof(double)) << k)
+            return k;
+    }
+    return -1;
+}
+
+/**
+ * @brief Checks a circular buffer size against the connection's buffer size limit.
+ * @param pool The connection's buffer pool, or NULL for no limit.
+ * @param size The size of the buffer in bytes.
+ * @return Non-zero if a buffer of this size is allowed.
+ */
+static int is_buffer_size_allowed(const StatsBufferPool *pool, size_t size) {
+    return !pool || pool->max_buffer_size <= 0 || size <= (sqlite3_uint64)pool->max_buffer_size;
+}
+
+/**
+ * @brief Takes a heap buffer of at least the given size from the pool, or allocates one.
+ *
+ * The largest idle buffer is preferred, so a new group directly reuses the storage a
+ * previous group grew to and skips the intermediate growth steps.
+ * @param pool The connection's buffer pool, or NULL.
+ * @param min_size The minimum size of the buffer in bytes.
+ * @param size Receives the actual size of the returned buffer.
+ * @return The buffer, or NULL on memory allocation failure.
+ */
+static void *acquire_pooled_buffer(StatsBufferPool *pool, size_t min_size, size_t *size) {
+    if (pool) {
+        for (int k = BUFFER_POOL_CLASSES - 1; k >= 0 && ((INITIAL_CAPACITY * sizeof(double)) << k) >= min_size; k--) {
+            if (pool->idle_counts[k] > 0 && is_buffer_size_allowed(pool, (INITIAL_CAPACITY * sizeof(double)) << k)) {
+                *size = (INITIAL_CAPACITY * sizeof(double)) << k;
+                return pool->idle_buffers[k][--pool->idle_counts[k]];
+            }
+        }
+    }
+    *size = min_size;
+    return sqlite3_malloc64(min_size);
+}
+
+/**
+ * @brief Returns a heap buffer to the pool, or frees it if the pool has no room for it.
+ * @param pool The connection's buffer pool, or NULL.
+ * @param buffer The buffer.
+ * @param size The size of the buffer in bytes.
+ */
+static void release_pooled_buffer(StatsBufferPool *pool, void *buffer, size_t size) {
+    int k = pool ? get_buffer_pool_class(size) : -1;
+    if (k >= 0 && pool->idle_counts[k] < BUFFER_POOL_DEPTH) {
+        pool->idle_buffers[k][pool->idle_counts[k]++] = buffer;
+        return;
+    }
+    sqlite3_free(buffer);
+}
+
+/**
+ * @brief Drops one reference to a buffer pool, freeing it and its idle buffers with the last one.
+ *
+ * Used as the user data destructor of the functions sharing the pool.
+ * @param pool The buffer pool.
+ */
+static void release_buffer_pool(void *pool) {
+    StatsBufferPool *p = (StatsBufferPool *)pool;
+    if (--p->ref_count > 0)
+        return;
+    for (int k = 0; k < BUFFER_POOL_CLASSES; k++) {
+        for (size_t i = 0; i < p->idle_counts[k]; i++)
+            sqlite3_free(p->idle_buffers[k][i]);
+    }
+    sqlite3_free(p);
+}
+
+/**
+ * @brief Error-free sum of two doubles (Knuth's TwoSum).
+ * @param a The first addend.
+ * @param b The second addend.
+ * @return The exact sum as a double-double.
+ */
+static DoubleDouble dd_two_sum(double a, double b) {
+    DoubleDouble r;
+    r.hi = a + b;
+    double bb = r.hi - a;
+    r.lo = (a - (r.hi - bb)) + (b - bb);
+    return r;
+}
+
+/**
+ * @brief Renormalizes `hi + lo` when |hi| >= |lo| (Dekker's FastTwoSum).
+ * @param hi The leading component.
+ * @param lo The trailing component.
+ * @return The normalized double-double.
+ */
+static DoubleDouble dd_quick_two_sum(double hi, double lo) {
+    DoubleDouble r;
+    r.hi = hi + lo;
+    r.lo = lo - (r.hi - hi);
+    return r;
+}
+
+/**
+ * @brief Adds two double-double numbers.
+ * @param a The first addend.
+ * @param b The second addend.
+ * @return The sum, accurate to about 106 bits.
+ */
+static DoubleDouble dd_add(DoubleDouble a, DoubleDouble b) {
+    DoubleDouble s = dd_two_sum(a.hi, b.hi);
+    DoubleDouble t = dd_two_sum(a.lo, b.lo);
+    s.lo += t.hi;
+    s = dd_quick_two_sum(s.hi, s.lo);
+    s.lo += t.lo;
+    return dd_quick_two_sum(s.hi, s.lo);
+}
+
+/**
+ * @brief Multiplies two double-double numbers, using `fma` for the exact product of the leading parts.
+ * @param a The first factor.
+ * @param b The second factor.
+ * @return The product, accurate to about 106 bits.
+ */
+static DoubleDouble dd_mul(DoubleDouble a, DoubleDouble b) {
+    double p = a.hi * b.hi;
+    double e = fma(a.hi, b.hi, -p);
+    e += a.hi * b.lo + a.lo * b.hi;
+    return dd_quick_two_sum(p, e);
+}
+
+/**
+ * @brief Divides a double-double number by a double.
+ * @param a The dividend.
+ * @param b The divisor.
+ * @return The quotient, accurate to about 106 bits.
+ */
+static DoubleDouble dd_div_double(DoubleDouble a, double b) {
+    double q1 = a.hi / b;
+    // Compute the remainder a - q1 * b exactly enough for the correction term.
+    double p = q1 * b;
+    double e = fma(q1, b, -p);
+    double r = ((a.hi - p) - e) + a.lo;
+    return dd_quick_two_sum(q1, r / b);
+}
+
+/**
+ * @brief Converts a 64-bit integer to a double-double exactly.
+ *
+ * The integer is split into a multiple of 2^32 and a remainder, both of which
+ * are exact as doubles, and joined with an error-free sum.
+ * @param value The integer.
+ * @return The double-double equal to `value`.
+ */
+static DoubleDouble dd_from_int64(sqlite3_int64 value) {
+    sqlite3_int64 high = value / 4294967296LL;
+    sqlite3_int64 low = value - high * 4294967296LL;
+    return dd_two_sum((double)high * 4294967296.0, (double)low);
+}
+
+/**
+ * @brief Adds a value to (sign = 1) or removes it from (sign = -1) the double-double accumulator.
+ * @param data The double-double precision state.
+ * @param value The INTEGER or REAL value to add or remove.
+ * @param sign 1 to add the value, -1 to remove it.
+ */
+static void update_precise_stats(PreciseStatsData *data, sqlite3_value *value, int sign) {
+    if (sign < 0 && data->count <= 1) {
+        memset(data, 0, sizeof(*data));
+        return;
+    }
+    int is_integer = sqlite3_value_type(value) == SQLITE_INTEGER;
+    if (data->count == 0) {
+        data->shift_is_integer = is_integer;
+        data->int_shift = is_integer ? sqlite3_value_int64(value) : 0;
+        data->shift = sqlite3_value_double(value);
+    }
+
+    // value - shift is exact. Between two INTEGERs it is formed from the differences
+    // of their halves, which cannot overflow. The square is accurate to about 106 bits.
+    DoubleDouble delta;
+    if (is_integer && data->shift_is_integer) {
+        sqlite3_int64 v = sqlite3_value_int64(value);
+        sqlite3_int64 s = data->int_shift;
+        sqlite3_int64 high = v / 4294967296LL - s / 4294967296LL;
+        sqlite3_int64 low = v % 4294967296LL - s % 4294967296LL;
+        delta = dd_two_sum((double)high * 4294967296.0, (double)low);
+    } else {
+        DoubleDouble v = is_integer ? dd_from_int64(sqlite3_value_int64(value)) : dd_two_sum(sqlite3_value_double(value), 0.0);
+        DoubleDouble s = data->shift_is_integer ? dd_from_int64(data->int_shift) : dd_two_sum(data->shift, 0.0);
+        s.hi = -s.hi;
+        s.lo = -s.lo;
+        delta = dd_add(v, s);
+    }
+    DoubleDouble delta_sq = dd_mul(delta, delta);
+    if (sign < 0) {
+        delta.hi = -delta.hi;
+        delta.lo = -delta.lo;
+        delta_sq.hi = -delta_sq.hi;
+        delta_sq.lo = -delta_sq.lo;
+        data->count--;
+    } else {
+        data->count++;
+    }
+    data->sum = dd_add(data->sum, delta);
+    data->sum_sq = dd_add(data->sum_sq, delta_sq);
+}
+
+/**
+ * @brief Condenses the double-double sums into the `stats` snapshot.
+ *
+ * The sum of squared deviations is computed as `sum_sq - sum^2 / n` in double-double
+ * arithmetic and rounded to double only at the end.
+ * @param data The double-double precision state.
+ */
+static void sync_precise_stats(PreciseStatsData *data) {
+    WindowStatsData *stats = &data->stats;
+    memset(stats, 0, sizeof(*stats));
+    if (data->count == 0)
+        return;
+
+    double n = (double)data->count;
+    DoubleDouble correction = dd_div_double(dd_mul(data->sum, data->sum), n);
+    correction.hi = -correction.hi;
+    correction.lo = -correction.lo;
+    DoubleDouble m2 = dd_add(data->sum_sq, correction);
+
+    stats->count = data->count;
+    stats->float_count = data->count;
+    stats->shift = data->shift;
+    stats->mean = dd_div_double(data->sum, n).hi;
+    stats->m2 = m2.hi > 0.0 ? m2.hi : 0.0;
+}
+
+/**
+ * @brief Shared "step" function of the exponentially weighted functions.
+ *
+ * The second argument sets the decay and must be the same for every row: either
+ * the smoothing factor `alpha` (0 < alpha <= 1), or a half-life in rows after
+ * which a weight has halved (`alpha = 1 - 2^(-1 / half_life)`).
+ * @param context The SQLite function context.
+ * @param argc The number of arguments.
+ * @param argv The argument values.
+ * @param halflife Non-zero if the second argument is a half-life rather than alpha.
+ */
+static void ew_step_helper(sqlite3_context *context, int argc, sqlite3_value **argv, int halflife) {
+    if (argc != 2) {
+        sqlite3_result_error(context, "Exponentially weighted functions require exactly 2 arguments", -1);
+        return;
+    }
+
+    EwStatsData *ctx = (EwStatsData *)sqlite3_aggregate_context(context, sizeof(EwStatsData));
+    if (!ctx) {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    int parameter_type = sqlite3_value_type(argv[1]);
+    double parameter = sqlite3_value_double(argv[1]);
+    double decay;
+    if (halflife) {
+        if ((parameter_type != SQLITE_INTEGER && parameter_type != SQLITE_FLOAT) || !(parameter > 0.0)) {
+            sqlite3_result_error(context, "Half-life argument must be greater than 0.0", -1);
+            return;
+        }
+        decay = pow(0.5, 1.0 / parameter);
+    } else {
+        if ((parameter_type != SQLITE_INTEGER && parameter_type != SQLITE_FLOAT) || !(parameter > 0.0 && parameter <= 1.0)) {
+            sqlite3_result_error(context, "Alpha argument must be greater than 0.0 and at most 1.0", -1);
+            return;
+        }
+        decay = 1.0 - parameter;
+    }
+    if (ctx->decay_known && decay != ctx->decay) {
+        sqlite3_result_error(context, "Decay argument must be the same for all rows", -1);
+        return;
+    }
+    ctx->decay = decay;
+    ctx->decay_known = 1;
+
+    int value_type = check_numeric_argument(context, argv[0]);
+    if (value_type != SQLITE_INTEGER && value_type != SQLITE_FLOAT)
+        return;
+
+    scale_ew_stats(ctx, ctx->decay);
+    add_weighted_to_ew_stats(ctx, sqlite3_value_double(argv[0]), 1.0);
+}
+
+/**
+ * @brief Shared "value"/"final" function of the exponentially weighted functions.
+ *
+ * The population form is the weighted variance `m2 / sum(w)`. The sample form
+ * applies the bias correction for reliability weights, `m2 * sum(w) / (sum(w)^2 - sum(w^2))`,
+ * which reduces to the usual `n - 1` denominator when all weights are equal.
+ * @param context The SQLite function context.
+ * @param sample Non-zero for the bias-corrected form.
+ * @param stddev Non-zero to return the square root of the variance.
+ */
+static void ew_value_helper(sqlite3_context *context, int sample, int stddev) {
+    EwStatsData *ctx = (EwStatsData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->count < (size_t)(sample ? MIN_COUNT_SAMPLE : MIN_COUNT_POPULATION)) {
+        sqlite3_result_null(context);
+        return;
+    }
+
+    double variance;
+    if (sample)
+        variance = ctx->m2 * ctx->sum_weights / (ctx->sum_weights * ctx->sum_weights - ctx->sum_weights_sq);
+    else
+        variance = ctx->m2 / ctx->sum_weights;
+    set_result(context, stddev ? sqrt(variance) : variance);
+}
+
+/**
+ * @brief Reads a timestamp argument of the time-weighted functions.
+ * @param context The SQLite function context, used to report errors.
+ * @param value The argument value.
+ * @param timestamp Receives the timestamp.
+ * @return Non-zero if the argument is a number; zero if it is NULL, in which case
+ *         the row is to be skipped, or of another type, in which case an error has been set.
+ */
+static int read_timestamp_argument(sqlite3_context *context, sqlite3_value *value, double *timestamp) {
+    int timestamp_type = sqlite3_value_type(value);
+    if (timestamp_type == SQLITE_NULL)
+        return 0;
+    if (timestamp_type != SQLITE_INTEGER && timestamp_type != SQLITE_FLOAT) {
+        sqlite3_result_error(context, "Invalid data type, expected numeric timestamp.", -1);
+        return 0;
+    }
+    *timestamp = sqlite3_value_double(value);
+    return 1;
+}
+
+/**
+ * @brief Multiplies all weights of an exponentially weighted accumulator by a factor.
+ * @param data The exponentially weighted state.
+ * @param factor The factor, between 0 and 1.
+ */
+static void scale_ew_stats(EwStatsData *data, double factor) {
+    data->sum_weights *= factor;
+    data->sum_weights_sq *= factor * factor;
+    data->m2 *= factor;
+}
+
+/**
+ * @brief Adds a weighted value to an exponentially weighted accumulator (weighted Welford update).
+ * @param data The exponentially weighted state.
+ * @param value The value to add.
+ * @param weight The weight of the value.
+ */
+static void add_weighted_to_ew_stats(EwStatsData *data, double value, double weight) {
+    if (data->count == 0)
+        data->shift = value;
+    value -= data->shift;
+    data->count++;
+    data->sum_weights += weight;
+    data->sum_weights_sq += weight * weight;
+    if (!(data->sum_weights > 0.0))
+        return; // All weights have underflowed.
+
+    double delta = value - data->mean;
+    data->mean += weight * delta / data->sum_weights;
+    data->m2 += weight * delta * (value - data->mean);
+}
+
+/**
+ * @brief Removes a weighted value from an exponentially weighted accumulator.
+ *
+ * Runs the weighted Welford update in reverse with the value's current weight.
+ * Removing the last value resets the accumulator, which clears any accumulated
+ * rounding error.
+ * @param data The exponentially weighted state.
+ * @param value The value, as passed to `add_weighted_to_ew_stats`.
+ * @param weight The current weight of the value.
+ */
+static void remove_weighted_from_ew_stats(EwStatsData *data, double value, double weight) {
+    if (data->count <= 1) {
+        data->count = 0;
+        data->sum_weights = 0.0;
+        data->sum_weights_sq = 0.0;
+        data->mean = 0.0;
+        data->m2 = 0.0;
+        return;
+    }
+
+    data->count--;
+    double remaining = data->sum_weights - weight;
+    if (!(remaining > 0.0)) {
+        // The remaining values carry no weight.
+        data->sum_weights = 0.0;
+        data->sum_weights_sq = 0.0;
+        data->mean = 0.0;
+        data->m2 = 0.0;
+        return;
+    }
+    if (weight == 0.0)
+        return; // The value no longer carries any weight.
+
+    value -= data->shift;
+    double delta = value - data->mean;
+    data->mean -= weight * delta / remaining;
+    data->m2 -= weight * delta * (value - data->mean);
+    if (data->m2 < 0.0)
+        data->m2 = 0.0;
+    data->sum_weights = remaining;
+    data->sum_weights_sq -= weight * weight;
+}
+
+/**
+ * @brief Adds a pair to the paired accumulator using the bivariate Welford update on shifted data.
+ * @param data The paired statistics data structure.
+ * @param y The first (dependent) value.
+ * @param x The second (independent) value.
+ */
+static void add_to_paired_stats(PairedStatsData *data, double y, double x) {
+    if (data->count == 0) {
+        data->shift_y = y;
+        data->shift_x = x;
+    }
+    y -= data->shift_y;
+    x -= data->shift_x;
+    data->count++;
+    double delta_y = y - data->mean_y;
+    double delta_x = x - data->mean_x;
+    data->mean_y += delta_y / (double)data->count;
+    data->mean_x += delta_x / (double)data->count;
+    data->m2_y += delta_y * (y - data->mean_y);
+    data->m2_x += delta_x * (x - data->mean_x);
+    data->c_xy += delta_x * (y - data->mean_y);
+}
+
+/**
+ * @brief Removes a pair from the paired accumulator by reversing the bivariate Welford update.
+ *
+ * As in `remove_from_window_stats`, removing the last pair resets the accumulator
+ * exactly, and the sums of squared deviations are clamped at zero.
+ * @param data The paired statistics data structure.
+ * @param y The first value of the pair. The pair must have been added previously.
+ * @param x The second value of the pair.
+ */
+static void remove_from_paired_stats(PairedStatsData *data, double y, double x) {
+    if (data->count == 0)
+        return;
+    if (--data->count == 0) {
+        memset(data, 0, sizeof(*data));
+        return;
+    }
+    y -= data->shift_y;
+    x -= data->shift_x;
+    double delta_y = y - data->mean_y;
+    double delta_x = x - data->mean_x;
+    data->mean_y -= delta_y / (double)data->count;
+    data->mean_x -= delta_x / (double)data->count;
+    data->m2_y -= delta_y * (y - data->mean_y);
+    data->m2_x -= delta_x * (x - data->mean_x);
+    data->c_xy -= delta_x * (y - data->mean_y);
+    if (data->m2_y < 0.0)
+        data->m2_y = 0.0;
+    if (data->m2_x < 0.0)
+        data->m2_x = 0.0;
+}
+
+/**
+ * @brief Generic "value" and "final" function for the paired statistics.
+ * @param context The SQLite function context.
+ * @param func The specific calculation function to call.
+ * @param min_count The minimum number of pairs required for the calculation.
+ */
+static void paired_value_helper(sqlite3_context *context, paired_func func, int min_count) {
+    PairedStatsData *ctx = (PairedStatsData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->count < (size_t)min_count) {
+        sqlite3_result_null(context);
+        return;
+    }
+    set_result(context, func(ctx));
 }
 
 /**
  * @brief Helper to set the result, handling NAN/INF values.
  * @param context The SQLite function context.
- * @param result The double result to set.
+ * @param result The double result to set.
+ */
+static void set_result(sqlite3_context *context, double result) {
+    if (isnan(result) || isinf(result)) {
+        sqlite3_result_null(context);
+    } else {
+        sqlite3_result_double(context, result);
+    }
+}
+
+/**
+ * @brief Generic "value" function for statistical calculations.
+ * @param context The SQLite function context.
+ * @param func The specific statistical function to call (e.g., calculate_stddev_sample).
+ * @param min_count The minimum number of data points required for the calculation.
+ */
+static void stats_value_helper(sqlite3_context *context, stats_func func, int min_count) {
+    WindowStatsData *ctx = (WindowStatsData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->count < (size_t)min_count) {
+        sqlite3_result_null(context);
+        return;
+    }
+    set_result(context, func(ctx));
+}
+
+/**
+ * @brief Generic "final" function for statistical calculations.
+ *
+ * This function calculates the final result for an aggregate. The accumulator
+ * lives entirely inside SQLite's aggregate context, so there is nothing to free.
+ * @param context The SQLite function context.
+ * @param func The specific statistical function to call.
+ * @param min_count The minimum number of data points required.
+ */
+static void stats_final_helper(sqlite3_context *context, stats_func func, int min_count) {
+    WindowStatsData *ctx = (WindowStatsData *)sqlite3_aggregate_context(context, 0);
+    if (ctx && ctx->count >= (size_t)min_count) {
+        set_result(context, func(ctx));
+    } else {
+        sqlite3_result_null(context);
+    }
+}
+
+/**
+ * @brief Generic "value" function for the double-double precision functions.
+ * @param context The SQLite function context.
+ * @param func The specific statistical function to call.
+ * @param min_count The minimum number of data points required for the calculation.
+ */
+static void precise_value_helper(sqlite3_context *context, stats_func func, int min_count) {
+    PreciseStatsData *ctx = (PreciseStatsData *)sqlite3_aggregate_context(context, 0);
+    if (ctx)
+        sync_precise_stats(ctx);
+    stats_value_helper(context, func, min_count);
+}
+
+/**
+ * @brief Generic "final" function for the double-double precision functions.
+ * @param context The SQLite function context.
+ * @param func The specific statistical function to call.
+ * @param min_count The minimum number of data points required.
+ */
+static void precise_final_helper(sqlite3_context *context, stats_func func, int min_count) {
+    PreciseStatsData *ctx = (PreciseStatsData *)sqlite3_aggregate_context(context, 0);
+    if (ctx)
+        sync_precise_stats(ctx);
+    stats_final_helper(context, func, min_count);
+}
+
+/**
+ * @brief Shared "value"/"final" function of `stddev_state` and `stddev_merge`.
+ *
+ * Returns the accumulator as a serialized state BLOB. A group without values
+ * yields the (valid, mergeable) empty state.
+ * @param context The SQLite function context.
+ */
+static void state_result_helper(sqlite3_context *context) {
+    WindowStatsData empty;
+    memset(&empty, 0, sizeof(empty));
+    WindowStatsData *ctx = (WindowStatsData *)sqlite3_aggregate_context(context, 0);
+    unsigned char buffer[STATS_STATE_MAX_SIZE];
+    size_t size = serialize_window_stats(ctx ? ctx : &empty, buffer);
+    sqlite3_result_blob(context, buffer, (int)size, SQLITE_TRANSIENT);
+}
+
+/**
+ * @brief Generic scalar finalizer, computing a statistic from a serialized state.
+ * @param context The SQLite function context.
+ * @param state The state BLOB argument.
+ * @param func The specific statistical function to call.
+ * @param min_count The minimum number of data points required.
+ */
+static void stats_finalize_helper(sqlite3_context *context, sqlite3_value *state, stats_func func, int min_count) {
+    if (sqlite3_value_type(state) == SQLITE_NULL) {
+        sqlite3_result_null(context);
+        return;
+    }
+    WindowStatsData data;
+    if (sqlite3_value_type(state) != SQLITE_BLOB ||
+        deserialize_window_stats(sqlite3_value_blob(state), sqlite3_value_bytes(state), &data) != SQLITE_OK) {
+        sqlite3_result_error(context, "Invalid data type, expected a stddev state BLOB.", -1);
+        return;
+    }
+    if (data.count < (size_t)min_count) {
+        sqlite3_result_null(context);
+        return;
+    }
+    set_result(context, func(&data));
+}
+
+/**
+ * @brief Generic scalar extractor, reading one statistic from a summary BLOB.
+ * @param context The SQLite function context.
+ * @param summary The summary BLOB argument.
+ * @param field The statistic to extract.
+ */
+static void summary_extract_helper(sqlite3_context *context, sqlite3_value *summary, SummaryField field) {
+    if (sqlite3_value_type(summary) == SQLITE_NULL) {
+        sqlite3_result_null(context);
+        return;
+    }
+    SummaryStatsData data;
+    if (sqlite3_value_type(summary) != SQLITE_BLOB ||
+        deserialize_summary_stats(sqlite3_value_blob(summary), sqlite3_value_bytes(summary), &data) != SQLITE_OK) {
+        sqlite3_result_error(context, "Invalid data type, expected a stats_summary_blob BLOB.", -1);
+        return;
+    }
+    if (field == SUMMARY_COUNT)
+        sqlite3_result_int64(context, (sqlite3_int64)data.stats.count);
+    else
+        set_result(context, calculate_summary_field(&data, field));
+}
+
+/**
+ * @brief Shared "value"/"final" function of `stats_summary`, returning all statistics as a JSON object.
+ *
+ * Statistics that are undefined for the group (e.g. the sample variance of a
+ * single value) are reported as JSON `null`.
+ * @param context The SQLite function context.
+ * @param is_final Non-zero when called as xFinal; the deques are then released.
+ */
+static void summary_json_helper(sqlite3_context *context, int is_final) {
+    static const char *field_names[SUMMARY_FIELD_COUNT] = {"count", "mean", "min", "max", "variance_samp", "variance_pop",
+                                                           "stddev_samp", "stddev_pop", "stderr", "cv"};
+    SummaryStatsData empty;
+    memset(&empty, 0, sizeof(empty));
+    SummaryStatsData *ctx = (SummaryStatsData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx)
+        ctx = &empty;
+
+    sqlite3_str *str = sqlite3_str_new(sqlite3_context_db_handle(context));
+    sqlite3_str_appendchar(str, 1, '{');
+    for (int field = 0; field < SUMMARY_FIELD_COUNT; field++) {
+        sqlite3_str_appendf(str, "%s\"%s\":", field ? "," : "", field_names[field]);
+        if (field == SUMMARY_COUNT)
+            sqlite3_str_appendf(str, "%lld", (sqlite3_int64)ctx->stats.count);
+        else
+            append_json_double(str, calculate_summary_field(ctx, (SummaryField)field));
+    }
+    sqlite3_str_appendchar(str, 1, '}');
+    if (is_final)
+        free_summary_deques(context, ctx);
+
+    if (sqlite3_str_errcode(str) != SQLITE_OK) {
+        sqlite3_free(sqlite3_str_finish(str));
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+    sqlite3_result_text(context, sqlite3_str_finish(str), -1, sqlite3_free);
+}
+
+/**
+ * @brief Shared "value"/"final" function of `stats_summary_blob`, returning the state as a BLOB.
+ *
+ * The BLOB is a regular accumulator state with a minimum/maximum section, so it can
+ * also be passed to `stddev_merge` and the `*_finalize` functions.
+ * @param context The SQLite function context.
+ * @param is_final Non-zero when called as xFinal; the deques are then released.
+ */
+static void summary_blob_helper(sqlite3_context *context, int is_final) {
+    SummaryStatsData empty;
+    memset(&empty, 0, sizeof(empty));
+    SummaryStatsData *ctx = (SummaryStatsData *)sqlite3_aggregate_context(context, 0);
+    unsigned char buffer[STATS_STATE_MAX_SIZE + STATS_STATE_MINMAX_SIZE];
+    size_t size = serialize_summary_stats(ctx ? ctx : &empty, buffer);
+    if (is_final && ctx)
+        free_summary_deques(context, ctx);
+    sqlite3_result_blob(context, buffer, (int)size, SQLITE_TRANSIENT);
+}
+
+/**
+ * @brief Shared "value"/"final" function of `stddev_cols`.
+ *
+ * Returns a JSON array with the sample standard deviation of each column, in
+ * argument order. Columns with fewer than two values are reported as `null`.
+ * @param context The SQLite function context.
+ */
+static void stddev_cols_helper(sqlite3_context *context) {
+    MultiColumnStatsData *ctx = (MultiColumnStatsData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->column_count == 0) {
+        sqlite3_result_null(context);
+        return;
+    }
+
+    sqlite3_str *str = sqlite3_str_new(sqlite3_context_db_handle(context));
+    sqlite3_str_appendchar(str, 1, '[');
+    for (int i = 0; i < ctx->column_count; i++) {
+        if (i > 0)
+            sqlite3_str_appendchar(str, 1, ',');
+        double stddev = ctx->counts[i] >= MIN_COUNT_SAMPLE ? sqrt(ctx->m2s[i] / (double)(ctx->counts[i] - 1)) : NAN;
+        append_json_double(str, stddev);
+    }
+    sqlite3_str_appendchar(str, 1, ']');
+
+    if (sqlite3_str_errcode(str) != SQLITE_OK) {
+        sqlite3_free(sqlite3_str_finish(str));
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+    sqlite3_result_text(context, sqlite3_str_finish(str), -1, sqlite3_free);
+}
+
+/**
+ * @brief Shared "value"/"final" function of the order statistics functions.
+ *
+ * Collects the ranks needed for all requested fractions and places them with one
+ * multi-rank selection pass. xFinal selects in place in the frame buffer when it
+ * holds contiguous doubles, since the buffer is discarded afterwards; otherwise,
+ * and always in xValue, where the frame order must survive for later inverse
+ * steps, the values are first copied to a scratch array. The result is a REAL,
+ * or for `quantiles` a JSON array in argument order. Empty groups return NULL.
+ * @param context The SQLite function context.
+ * @param method How to derive each quantile from the selected ranks.
+ * @param as_json Non-zero to return all fractions as a JSON array.
+ * @param is_final Non-zero when called as xFinal; the frame buffer is then released.
+ */
+static void quantile_result_helper(sqlite3_context *context, QuantileMethod method, int as_json, int is_final) {
+    QuantileData *ctx = (QuantileData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->ring.count == 0) {
+        sqlite3_result_null(context);
+        if (ctx && is_final)
+            free_circular_buffer(&ctx->ring, (StatsBufferPool *)sqlite3_user_data(context));
+        return;
+    }
+
+    StatsRingBuffer *ring = &ctx->ring;
+    size_t n = ring->count;
+    double *scratch;
+    double *values = get_contiguous_values(ring, is_final, &scratch);
+    if (!values) {
+        sqlite3_result_error_nomem(context);
+        if (is_final)
+            free_circular_buffer(ring, (StatsBufferPool *)sqlite3_user_data(context));
+        return;
+    }
+
+    // Collect the ranks of all fractions, sorted and without duplicates.
+    size_t rank_count = 0;
+    for (int i = 0; i < ctx->fraction_count; i++) {
+        double position = ctx->fractions[i] * (double)(n - 1);
+        size_t lower = (size_t)position;
+        size_t needed[2] = {lower, lower + 1};
+        int needed_count = method == QUANTILE_CONTINUOUS && position > (double)lower ? 2 : 1;
+        for (int j = 0; j < needed_count; j++) {
+            size_t pos = rank_count;
+            while (pos > 0 && ctx->ranks[pos - 1] > needed[j])
+                pos--;
+            if (pos > 0 && ctx->ranks[pos - 1] == needed[j])
+                continue;
+            memmove(ctx->ranks + pos + 1, ctx->ranks + pos, (rank_count - pos) * sizeof(size_t));
+            ctx->ranks[pos] = needed[j];
+            rank_count++;
+        }
+    }
+    select_ranks(values, 0, n, ctx->ranks, rank_count);
+
+    if (!as_json) {
+        sqlite3_result_double(context, get_selected_quantile(values, n, ctx->fractions[0], method));
+    } else {
+        sqlite3_str *str = sqlite3_str_new(sqlite3_context_db_handle(context));
+        sqlite3_str_appendchar(str, 1, '[');
+        for (int i = 0; i < ctx->fraction_count; i++) {
+            if (i > 0)
+                sqlite3_str_appendchar(str, 1, ',');
+            append_json_double(str, get_selected_quantile(values, n, ctx->fractions[i], method));
+        }
+        sqlite3_str_appendchar(str, 1, ']');
+        if (sqlite3_str_errcode(str) != SQLITE_OK) {
+            sqlite3_free(sqlite3_str_finish(str));
+            sqlite3_result_error_nomem(context);
+        } else {
+            sqlite3_result_text(context, sqlite3_str_finish(str), -1, sqlite3_free);
+        }
+    }
+
+    sqlite3_free(scratch);
+    if (is_final)
+        free_circular_buffer(ring, (StatsBufferPool *)sqlite3_user_data(context));
+}
+
+/**
+ * @brief Gets the values of a frame buffer as one contiguous, modifiable array of doubles.
+ * @param ring The frame buffer, holding at least one value.
+ * @param in_place Non-zero if the buffer may be reordered, because it is about to be released.
+ * @param scratch Receives the scratch array the values were copied to, to be freed
+ *        with `sqlite3_free`, or NULL if the buffer's storage is used directly.
+ * @return The values, or NULL on memory allocation failure.
+ */
+static double *get_contiguous_values(StatsRingBuffer *ring, int in_place, double **scratch) {
+    *scratch = NULL;
+    if (in_place && !ring->compact && ring->head + ring->count <= ring->capacity)
+        return (double *)ring->values + ring->head;
+    *scratch = (double *)sqlite3_malloc64(ring->count * sizeof(double));
+    if (!*scratch)
+        return NULL;
+    for (size_t i = 0; i < ring->count; i++)
+        (*scratch)[i] = get_circular_value(ring, i);
+    return *scratch;
+}
+
+/**
+ * @brief Computes a quantile from values whose needed ranks have been selected.
+ *
+ * The position of fraction `p` among `n` values is `p * (n - 1)`, as in SQLite's
+ * own percentile functions. The discrete method returns the value at the rank
+ * below that position; the continuous method interpolates to the next rank.
+ * @param values The values, with the needed ranks in their sorted positions.
+ * @param count The number of values, at least 1.
+ * @param fraction The fraction between 0 and 1.
+ * @param method How to derive the quantile.
+ * @return The quantile.
+ */
+static double get_selected_quantile(const double *values, size_t count, double fraction, QuantileMethod method) {
+    double position = fraction * (double)(count - 1);
+    size_t lower = (size_t)position;
+    double result = values[lower];
+    if (method == QUANTILE_CONTINUOUS && position > (double)lower)
+        result += (position - (double)lower) * (values[lower + 1] - values[lower]);
+    return result;
+}
+
+/**
+ * @brief Moves the values of several ranks to their sorted positions.
+ *
+ * Selects the middle rank first, which splits the range, and then recurses into
+ * both halves with the remaining ranks, so m ranks cost O(n log m) comparisons.
+ * @param values The values.
+ * @param lo The start of the range (inclusive).
+ * @param hi The end of the range (exclusive).
+ * @param ranks The sorted, distinct ranks to select, all within the range.
+ * @param rank_count The number of ranks.
+ */
+static void select_ranks(double *values, size_t lo, size_t hi, const size_t *ranks, size_t rank_count) {
+    if (rank_count == 0)
+        return;
+    size_t middle = rank_count / 2;
+    size_t k = ranks[middle];
+    introselect(values, lo, hi, k);
+    select_ranks(values, lo, k, ranks, middle);
+    select_ranks(values, k + 1, hi, ranks + middle + 1, rank_count - middle - 1);
+}
+
+/**
+ * @brief Moves the value of rank `k` to position `k` (introselect).
+ *
+ * Quickselect with a median-of-three pivot and Hoare partitioning, which splits runs
+ * of equal values evenly. Once the partitioning depth exceeds twice the logarithm of
+ * the range size, the remaining range is heapsorted, bounding the worst case at
+ * O(n log n). Small ranges are finished with an insertion sort. Afterwards no value
+ * before position `k` is larger and none after it is smaller.
+ * @param values The values.
+ * @param lo The start of the range (inclusive).
+ * @param hi The end of the range (exclusive).
+ * @param k The rank to select, within the range.
+ */
+static void introselect(double *values, size_t lo, size_t hi, size_t k) {
+    size_t depth_limit = 0;
+    for (size_t n = hi - lo; n > 1; n >>= 1)
+        depth_limit += 2;
+
+    while (hi - lo > 16) {
+        if (depth_limit-- == 0) {
+            heapsort_doubles(values + lo, hi - lo);
+            return;
+        }
+
+        // Order the first, middle and last values and use the middle one as the pivot.
+        size_t mid = lo + (hi - lo) / 2;
+        if (values[mid] < values[lo])
+            swap_doubles(&values[mid], &values[lo]);
+        if (values[hi - 1] < values[mid]) {
+            swap_doubles(&values[hi - 1], &values[mid]);
+            if (values[mid] < values[lo])
+                swap_doubles(&values[mid], &values[lo]);
+        }
+        double pivot = values[mid];
+
+        size_t i = lo, j = hi - 1;
+        for (;;) {
+            while (values[i] < pivot)
+                i++;
+            while (values[j] > pivot)
+                j--;
+            if (i >= j)
+                break;
+            swap_doubles(&values[i], &values[j]);
+            i++;
+            j--;
+        }
+        // Now values[lo..j] <= pivot <= values[j+1..hi-1], with both parts non-empty.
+        if (k <= j)
+            hi = j + 1;
+        else
+            lo = j + 1;
+    }
+
+    for (size_t i = lo + 1; i < hi; i++) {
+        double value = values[i];
+        size_t j = i;
+        while (j > lo && values[j - 1] > value) {
+            values[j] = values[j - 1];
+            j--;
+        }
+        values[j] = value;
+    }
+}
+
+/**
+ * @brief Sorts an array of doubles in ascending order with heapsort.
+ * @param values The values.
+ * @param count The number of values.
+ */
+static void heapsort_doubles(double *values, size_t count) {
+    for (size_t start = count / 2; start-- > 0;)
+        sift_down_doubles(values, start, count);
+    for (size_t end = count; end-- > 1;) {
+        swap_doubles(&values[0], &values[end]);
+        sift_down_doubles(values, 0, end);
+    }
+}
+
+/**
+ * @brief Restores the max-heap property below a node of a binary heap of doubles.
+ * @param values The heap.
+ * @param root The node whose subtree is to be fixed.
+ * @param count The number of values in the heap.
+ */
+static void sift_down_doubles(double *values, size_t root, size_t count) {
+    for (size_t child; (child = 2 * root + 1) < count; root = child) {
+        if (child + 1 < count && values[child] < values[child + 1])
+            child++;
+        if (!(values[root] < values[child]))
+            return;
+        swap_doubles(&values[root], &values[child]);
+    }
+}
+
+/**
+ * @brief Exchanges two doubles.
+ * @param a The first value.
+ * @param b The second value.
+ */
+static void swap_doubles(double *a, double *b) {
+    double t = *a;
+    *a = *b;
+    *b = t;
+}
+
+/**
+ * @brief Reads a fraction argument of the order statistics functions.
+ * @param context The SQLite function context, used to report errors.
+ * @param value The argument value.
+ * @param fraction Receives the fraction.
+ * @return Non-zero if the argument is a number between 0 and 1; otherwise an error has been set.
+ */
+static int read_fraction_argument(sqlite3_context *context, sqlite3_value *value, double *fraction) {
+    int fraction_type = sqlite3_value_type(value);
+    *fraction = sqlite3_value_double(value);
+    if ((fraction_type != SQLITE_INTEGER && fraction_type != SQLITE_FLOAT) || !(*fraction >= 0.0 && *fraction <= 1.0)) {
+        sqlite3_result_error(context, "Fraction argument must be between 0.0 and 1.0", -1);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Inserts a value into an order statistic tree.
+ * @param tree The tree.
+ * @param value The value.
+ * @param pool The connection's buffer pool, whose buffer size limit also bounds the node array, or NULL.
+ * @return SQLITE_OK on success, SQLITE_TOOBIG if the node array would exceed the
+ *         buffer size limit, SQLITE_NOMEM on memory allocation failure.
+ */
+static int insert_into_tree(OrderStatisticTree *tree, double value, const StatsBufferPool *pool) {
+    unsigned int index = tree->free_list;
+    if (index) {
+        tree->free_list = tree->nodes[index].left;
+    } else {
+        if (tree->used + 1 >= tree->capacity) {
+            size_t new_capacity = tree->capacity ? tree->capacity * 2 : INITIAL_CAPACITY;
+            if (new_capacity > UINT_MAX || !is_buffer_size_allowed(pool, new_capacity * sizeof(TreapNode)))
+                return SQLITE_TOOBIG;
+            TreapNode *new_nodes = (TreapNode *)sqlite3_realloc64(tree->nodes, new_capacity * sizeof(TreapNode));
+            if (!new_nodes)
+                return SQLITE_NOMEM;
+            if (!tree->nodes)
+                memset(new_nodes, 0, sizeof(TreapNode)); // The sentinel.
+            tree->nodes = new_nodes;
+            tree->capacity = new_capacity;
+        }
+        index = (unsigned int)++tree->used;
+    }
+
+    // xorshift32; any non-zero seed works.
+    unsigned int seed = tree->seed ? tree->seed : 2463534242u;
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    tree->seed = seed;
+
+    TreapNode *node = &tree->nodes[index];
+    node->value = value;
+    node->priority = seed;
+    node->left = 0;
+    node->right = 0;
+    node->size = 1;
+    tree->root = insert_treap_node(tree->nodes, tree->root, index);
+    return SQLITE_OK;
+}
+
+/**
+ * @brief Deletes one occurrence of a value from an order statistic tree.
+ * @param tree The tree.
+ * @param value The value.
+ * @return Non-zero if the value was found and deleted.
+ */
+static int remove_from_tree(OrderStatisticTree *tree, double value) {
+    unsigned int removed = 0;
+    if (tree->root)
+        tree->root = remove_treap_node(tree->nodes, tree->root, value, &removed);
+    if (!removed)
+        return 0;
+    tree->nodes[removed].left = tree->free_list;
+    tree->free_list = removed;
+    return 1;
+}
+
+/**
+ * @brief Finds the value of a given rank in an order statistic tree.
+ * @param tree The tree.
+ * @param rank The 0-based rank, less than the number of values.
+ * @return The value with `rank` smaller or equal values before it.
+ */
+static double select_from_tree(const OrderStatisticTree *tree, size_t rank) {
+    const TreapNode *nodes = tree->nodes;
+    unsigned int index = tree->root;
+    for (;;) {
+        size_t left_size = nodes[nodes[index].left].size;
+        if (rank < left_size) {
+            index = nodes[index].left;
+        } else if (rank == left_size) {
+            return nodes[index].value;
+        } else {
+            rank -= left_size + 1;
+            index = nodes[index].right;
+        }
+    }
+}
+
+/**
+ * @brief Computes a continuous quantile of a non-empty order statistic tree.
+ *
+ * Interpolates between the two values closest to position `p * (n - 1)`, like
+ * `percentile_cont`, selecting each by rank in O(log n).
+ * @param tree The tree.
+ * @param fraction The fraction between 0 and 1.
+ * @return The quantile.
+ */
+static double get_tree_quantile(const OrderStatisticTree *tree, double fraction) {
+    size_t n = tree->nodes[tree->root].size;
+    double position = fraction * (double)(n - 1);
+    size_t lower = (size_t)position;
+    double result = select_from_tree(tree, lower);
+    if (position > (double)lower)
+        result += (position - (double)lower) * (select_from_tree(tree, lower + 1) - result);
+    return result;
+}
+
+/**
+ * @brief Finds the absolute deviation of a given rank in an order statistic tree.
+ *
+ * The values below `split` are at most `center` and those from it on at least
+ * `center`, so the deviations form two sorted sequences: `center - x` walking down
+ * from the split, and `x - center` walking up. The rank is found in their merged
+ * order by a binary search over how many deviations come from the lower one,
+ * reading values by rank, in O(log^2 n).
+ * @param tree The tree.
+ * @param center The center the deviations are measured from.
+ * @param split The rank of the first value at or above `center`, such that all values below it are at most `center`.
+ * @param rank The 0-based rank of the deviation, less than the number of values.
+ * @return The deviation with `rank` smaller or equal deviations before it.
+ */
+static double select_deviation_from_tree(const OrderStatisticTree *tree, double center, size_t split, size_t rank) {
+    size_t upper_count = tree->nodes[tree->root].size - split;
+    size_t taken = rank + 1;
+    size_t lo = taken > upper_count ? taken - upper_count : 0;
+    size_t hi = taken < split ? taken : split;
+    // Find the smallest number i of lower deviations such that the next lower
+    // deviation is not smaller than the last of the `taken - i` upper ones.
+    while (lo < hi) {
+        size_t i = lo + (hi - lo) / 2;
+        double next_lower = center - select_from_tree(tree, split - 1 - i);
+        double last_upper = select_from_tree(tree, split + taken - i - 1) - center;
+        if (next_lower < last_upper)
+            lo = i + 1;
+        else
+            hi = i;
+    }
+    double result = 0.0;
+    if (lo > 0)
+        result = center - select_from_tree(tree, split - lo);
+    if (taken > lo) {
+        double last_upper = select_from_tree(tree, split + taken - lo - 1) - center;
+        if (last_upper > result)
+            result = last_upper;
+    }
+    return result;
+}
+
+/**
+ * @brief Frees the node array of an order statistic tree, leaving an empty tree.
+ * @param tree The tree.
+ */
+static void free_tree(OrderStatisticTree *tree) {
+    sqlite3_free(tree->nodes);
+    memset(tree, 0, sizeof(*tree));
+}
+
+/**
+ * @brief Inserts a node into a treap.
+ *
+ * Descends by value until the new node's priority exceeds that of the subtree root,
+ * then splits that subtree around the new node. Equal values go to the right.
+ * @param nodes The node array.
+ * @param root The root of the treap, or 0.
+ * @param node The index of the new node, a single-node tree.
+ * @return The new root of the treap.
+ */
+static unsigned int insert_treap_node(TreapNode *nodes, unsigned int root, unsigned int node) {
+    if (!root)
+        return node;
+    if (nodes[node].priority > nodes[root].priority) {
+        split_treap(nodes, root, nodes[node].value, &nodes[node].left, &nodes[node].right);
+        nodes[node].size = 1 + nodes[nodes[node].left].size + nodes[nodes[node].right].size;
+        return node;
+    }
+    if (nodes[node].value < nodes[root].value)
+        nodes[root].left = insert_treap_node(nodes, nodes[root].left, node);
+    else
+        nodes[root].right = insert_treap_node(nodes, nodes[root].right, node);
+    nodes[root].size++;
+    return root;
+}
+
+/**
+ * @brief Deletes one node with a given value from a treap, joining its children in its place.
+ * @param nodes The node array.
+ * @param root The root of the treap, or 0.
+ * @param value The value to delete.
+ * @param removed Receives the index of the deleted node, or stays 0 if the value is absent.
+ * @return The new root of the treap.
+ */
+static unsigned int remove_treap_node(TreapNode *nodes, unsigned int root, double value, unsigned int *removed) {
+    if (!root)
+        return 0;
+    if (value < nodes[root].value) {
+        nodes[root].left = remove_treap_node(nodes, nodes[root].left, value, removed);
+    } else if (value > nodes[root].value) {
+        nodes[root].right = remove_treap_node(nodes, nodes[root].right, value, removed);
+    } else {
+        *removed = root;
+        return merge_treaps(nodes, nodes[root].left, nodes[root].right);
+    }
+    if (*removed)
+        nodes[root].size--;
+    return root;
+}
+
+/**
+ * @brief Splits a treap into the values less than a given value and the rest.
+ * @param nodes The node array.
+ * @param root The root of the treap, or 0.
+ * @param value The split value.
+ * @param left Receives the root of the treap with the smaller values.
+ * @param right Receives the root of the treap with the greater or equal values.
+ */
+static void split_treap(TreapNode *nodes, unsigned int root, double value, unsigned int *left, unsigned int *right) {
+    if (!root) {
+        *left = 0;
+        *right = 0;
+        return;
+    }
+    if (nodes[root].value < value) {
+        split_treap(nodes, nodes[root].right, value, &nodes[root].right, right);
+        *left = root;
+    } else {
+        split_treap(nodes, nodes[root].left, value, left, &nodes[root].left);
+        *right = root;
+    }
+    nodes[root].size = 1 + nodes[nodes[root].left].size + nodes[nodes[root].right].size;
+}
+
+/**
+ * @brief Joins two treaps whose values are ordered (every value of `left` precedes those of `right`).
+ * @param nodes The node array.
+ * @param left The root of the first treap, or 0.
+ * @param right The root of the second treap, or 0.
+ * @return The root of the joined treap.
+ */
+static unsigned int merge_treaps(TreapNode *nodes, unsigned int left, unsigned int right) {
+    if (!left)
+        return right;
+    if (!right)
+        return left;
+    if (nodes[left].priority > nodes[right].priority) {
+        nodes[left].right = merge_treaps(nodes, nodes[left].right, right);
+        nodes[left].size = 1 + nodes[nodes[left].left].size + nodes[nodes[left].right].size;
+        return left;
+    }
+    nodes[right].left = merge_treaps(nodes, left, nodes[right].left);
+    nodes[right].size = 1 + nodes[nodes[right].left].size + nodes[nodes[right].right].size;
+    return right;
+}
+
+/**
+ * @brief Shared "value"/"final" function of the quantile sketch functions.
+ * @param context The SQLite function context.
+ * @param as_state Non-zero to return the serialized sketch (`quantile_sketch`,
+ *        `quantile_sketch_merge`), zero for the estimated quantile (`approx_median`, `approx_quantile`).
+ * @param is_final Non-zero when called as xFinal, to free the sketch.
  */
-static void set_result(sqlite3_context *context, double result) {
-    if (isnan(result) || isinf(result)) {
+static void sketch_result_helper(sqlite3_context *context, int as_state, int is_final) {
+    QuantileSketchData empty;
+    memset(&empty, 0, sizeof(empty));
+    QuantileSketchData *ctx = (QuantileSketchData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx)
+        ctx = &empty;
+
+    if (as_state) {
+        size_t size;
+        unsigned char *buffer = serialize_quantile_sketch(ctx, &size);
+        if (buffer)
+            sqlite3_result_blob64(context, buffer, size, sqlite3_free);
+        else
+            sqlite3_result_error_nomem(context);
+    } else if (ctx->negative.total + ctx->zero_count + ctx->positive.total <= 0) {
         sqlite3_result_null(context);
     } else {
-        sqlite3_result_double(context, result);
+        sqlite3_result_double(context, get_sketch_quantile(ctx, ctx->fraction));
     }
+
+    if (is_final)
+        free_quantile_sketch(ctx);
 }
 
 /**
- * @brief Generic "value" function for statistical calculations.
+ * @brief Adds a value to, or removes it from, a quantile sketch.
+ * @param sketch The sketch.
+ * @param value The value.
+ * @param delta 1 to add the value, -1 to remove it.
+ * @return SQLITE_OK on success, SQLITE_NOMEM on memory allocation failure.
+ */
+static int add_to_sketch(QuantileSketchData *sketch, double value, sqlite3_int64 delta) {
+    if (value > 0.0)
+        return add_to_sketch_store(&sketch->positive, get_sketch_bucket_index(value), delta);
+    if (value < 0.0)
+        return add_to_sketch_store(&sketch->negative, get_sketch_bucket_index(-value), delta);
+    sketch->zero_count += delta;
+    return SQLITE_OK;
+}
+
+/**
+ * @brief Adds to the count of one bucket of a sketch store.
+ *
+ * Values below the store's range are counted in the collapse bucket, and so is
+ * the removal of values that were present when buckets were collapsed.
+ * Removals never grow the store.
+ * @param store The store.
+ * @param index The bucket index.
+ * @param delta The count to add; negative to remove values.
+ * @return SQLITE_OK on success, SQLITE_NOMEM on memory allocation failure.
+ */
+static int add_to_sketch_store(SketchStore *store, int index, sqlite3_int64 delta) {
+    if (delta < 0) {
+        if (store->collapse_pending > 0) {
+            if (index < store->collapse_index)
+                index = store->collapse_index;
+            store->collapse_pending = store->collapse_pending > -delta ? store->collapse_pending + delta : 0;
+        }
+        if (!store->counts || index >= store->offset + store->capacity)
+            return SQLITE_OK; // Never added.
+        if (index < store->offset)
+            index = store->offset;
+    } else if (!store->counts || index < store->offset || index >= store->offset + store->capacity) {
+        int rc = resize_sketch_store(store, index);
+        if (rc != SQLITE_OK)
+            return rc;
+        if (index < store->offset) {
+            // The new value itself is collapsed.
+            index = store->collapse_index;
+            store->collapse_pending += delta;
+        }
+    }
+    store->counts[index - store->offset] += delta;
+    store->total += delta;
+    return SQLITE_OK;
+}
+
+/**
+ * @brief Reallocates a sketch store so that its range covers a bucket index.
+ *
+ * The new range spans the non-empty buckets and the index, with the spare room
+ * on the side it grows towards, and its capacity doubles as needed up to
+ * `SKETCH_MAX_BUCKETS`. If that is not enough, it keeps the highest buckets and
+ * the lower ones, and possibly the index, are collapsed into its lowest bucket.
+ * Values still pending from an earlier collapse must stay findable, so a collapse
+ * bucket never moves down while such values remain. An empty store is simply
+ * recentred on the index.
+ * @param store The store.
+ * @param index The bucket index to cover.
+ * @return SQLITE_OK on success, SQLITE_NOMEM on memory allocation failure.
+ */
+static int resize_sketch_store(SketchStore *store, int index) {
+    if (store->counts && store->total == 0) {
+        memset(store->counts, 0, (size_t)store->capacity * sizeof(sqlite3_int64));
+        store->offset = index - store->capacity / 2;
+        store->collapse_pending = 0;
+        return SQLITE_OK;
+    }
+
+    int capacity = store->capacity ? store->capacity : SKETCH_INITIAL_BUCKETS;
+    int lo = index - capacity / 2;
+    int collapse_index = 0, collapse = 0;
+    if (store->counts) {
+        int first = 0, last = store->capacity - 1;
+        while (store->counts[first] == 0)
+            first++;
+        while (store->counts[last] == 0)
+            last--;
+        first += store->offset;
+        last += store->offset;
+        lo = index < first ? index : first;
+        int hi = index > last ? index : last;
+        while (capacity <= hi - lo && capacity < SKETCH_MAX_BUCKETS)
+            capacity *= 2;
+        if (capacity > SKETCH_MAX_BUCKETS)
+            capacity = SKETCH_MAX_BUCKETS;
+        if (capacity <= hi - lo) {
+            lo = hi - capacity + 1;
+            collapse = 1;
+            collapse_index = lo;
+            if (store->collapse_pending > 0 && store->collapse_index > collapse_index && store->collapse_index <= hi)
+                collapse_index = store->collapse_index;
+        } else if (index < first) {
+            lo = hi - capacity + 1;
+        }
+    }
+
+    sqlite3_int64 *counts = (sqlite3_int64 *)sqlite3_malloc64((size_t)capacity * sizeof(sqlite3_int64));
+    if (!counts)
+        return SQLITE_NOMEM;
+    memset(counts, 0, (size_t)capacity * sizeof(sqlite3_int64));
+    for (int i = 0; i < store->capacity; i++) {
+        int old_index = store->offset + i;
+        if (store->counts[i] != 0)
+            counts[(collapse && old_index < collapse_index ? collapse_index : old_index) - lo] += store->counts[i];
+    }
+    if (collapse) {
+        store->collapse_index = collapse_index;
+        store->collapse_pending = store->total;
+    }
+    sqlite3_free(store->counts);
+    store->counts = counts;
+    store->offset = lo;
+    store->capacity = capacity;
+    return SQLITE_OK;
+}
+
+/**
+ * @brief Finds the sketch bucket of a magnitude.
+ * @param magnitude A positive value; infinity is counted in the bucket of the largest double.
+ * @return The bucket index `ceil(log_gamma(magnitude))`.
+ */
+static int get_sketch_bucket_index(double magnitude) {
+    if (magnitude > DBL_MAX)
+        magnitude = DBL_MAX;
+    return (int)ceil(log(magnitude) / log(SKETCH_GAMMA));
+}
+
+/**
+ * @brief Estimates the values of a sketch bucket.
+ * @param index The bucket index.
+ * @return The point of bucket `(gamma^(index-1), gamma^index]` with the smallest
+ *         maximum relative error, `2 * gamma^index / (gamma + 1)`.
+ */
+static double get_sketch_bucket_value(int index) {
+    return exp(index * log(SKETCH_GAMMA) + log(2.0 / (SKETCH_GAMMA + 1.0)));
+}
+
+/**
+ * @brief Estimates a quantile from a non-empty sketch.
+ *
+ * Interpolates between the estimates of the two ranks closest to position
+ * `p * (n - 1)`, like `percentile_cont`.
+ * @param sketch The sketch.
+ * @param fraction The fraction between 0 and 1.
+ * @return The estimated quantile.
+ */
+static double get_sketch_quantile(const QuantileSketchData *sketch, double fraction) {
+    sqlite3_int64 count = sketch->negative.total + sketch->zero_count + sketch->positive.total;
+    double position = fraction * (double)(count - 1);
+    sqlite3_int64 lower = (sqlite3_int64)position;
+    double result = select_from_sketch(sketch, lower);
+    if (position > (double)lower)
+        result += (position - (double)lower) * (select_from_sketch(sketch, lower + 1) - result);
+    return result;
+}
+
+/**
+ * @brief Estimates the value of a given rank in a sketch.
+ * @param sketch The sketch.
+ * @param rank The 0-based rank, less than the number of values.
+ * @return The estimate of the bucket containing the rank.
+ */
+static double select_from_sketch(const QuantileSketchData *sketch, sqlite3_int64 rank) {
+    const SketchStore *negative = &sketch->negative;
+    for (int i = negative->capacity - 1; i >= 0; i--) {
+        if (rank < negative->counts[i])
+            return -get_sketch_bucket_value(negative->offset + i);
+        rank -= negative->counts[i];
+    }
+    if (rank < sketch->zero_count)
+        return 0.0;
+    rank -= sketch->zero_count;
+    const SketchStore *positive = &sketch->positive;
+    for (int i = 0; i < positive->capacity; i++) {
+        if (rank < positive->counts[i])
+            return get_sketch_bucket_value(positive->offset + i);
+        rank -= positive->counts[i];
+    }
+    return 0.0; // Not reached for consistent counts.
+}
+
+/**
+ * @brief Serializes a quantile sketch into an endian-portable BLOB.
+ *
+ * Layout (all multi-byte fields big-endian):
+ *   - byte 0: format version (`SKETCH_STATE_VERSION`)
+ *   - byte 1: type tag (`SKETCH_STATE_TAG`), which tells sketches apart from stddev states
+ *   - relative accuracy (IEEE 754 double) and number of zeros (u64)
+ *   - for the negative and then the positive store: the index of the first
+ *     non-empty bucket (i64), the number of buckets n (u64), and n counts (u64 each)
+ * @param sketch The sketch.
+ * @param size Receives the size of the BLOB in bytes.
+ * @return The BLOB, to be freed with `sqlite3_free`, or NULL on memory allocation failure.
+ */
+static unsigned char *serialize_quantile_sketch(const QuantileSketchData *sketch, size_t *size) {
+    const SketchStore *stores[2] = {&sketch->negative, &sketch->positive};
+    int first[2], count[2];
+    for (int s = 0; s < 2; s++) {
+        int lo = 0, hi = stores[s]->capacity;
+        while (lo < hi && stores[s]->counts[lo] == 0)
+            lo++;
+        while (hi > lo && stores[s]->counts[hi - 1] == 0)
+            hi--;
+        first[s] = stores[s]->offset + lo;
+        count[s] = hi - lo;
+    }
+
+    *size = SKETCH_STATE_HEADER_SIZE + ((size_t)count[0] + (size_t)count[1]) * 8;
+    unsigned char *buffer = (unsigned char *)sqlite3_malloc64(*size);
+    if (!buffer)
+        return NULL;
+    buffer[0] = SKETCH_STATE_VERSION;
+    buffer[1] = SKETCH_STATE_TAG;
+    put_double(buffer + 2, SKETCH_RELATIVE_ACCURACY);
+    put_uint64(buffer + 10, (sqlite3_uint64)sketch->zero_count);
+    unsigned char *p = buffer + 18;
+    for (int s = 0; s < 2; s++) {
+        put_uint64(p, (sqlite3_uint64)(sqlite3_int64)first[s]);
+        put_uint64(p + 8, (sqlite3_uint64)count[s]);
+        p += 16;
+        for (int i = 0; i < count[s]; i++, p += 8)
+            put_uint64(p, (sqlite3_uint64)stores[s]->counts[first[s] - stores[s]->offset + i]);
+    }
+    return buffer;
+}
+
+/**
+ * @brief Adds a serialized sketch to a sketch, or subtracts it.
+ *
+ * The BLOB is validated completely before the sketch is changed.
+ * @param sketch The sketch.
+ * @param buffer The BLOB written by `serialize_quantile_sketch`.
+ * @param size The size of the BLOB in bytes.
+ * @param sign 1 to add the serialized sketch, -1 to subtract it.
+ * @return SQLITE_OK on success, SQLITE_ERROR if the BLOB is not a valid sketch of
+ *         the same accuracy, SQLITE_NOMEM on memory allocation failure.
+ */
+static int merge_quantile_sketch(QuantileSketchData *sketch, const unsigned char *buffer, int size, int sign) {
+    // Bucket indexes of doubles stay far below this bound at any sensible accuracy.
+    const sqlite3_int64 max_index = 1 << 24;
+    if (!buffer || size < SKETCH_STATE_HEADER_SIZE || buffer[0] != SKETCH_STATE_VERSION || buffer[1] != SKETCH_STATE_TAG ||
+        get_double(buffer + 2) != SKETCH_RELATIVE_ACCURACY || get_uint64(buffer + 10) > (sqlite3_uint64)LLONG_MAX)
+        return SQLITE_ERROR;
+    sqlite3_int64 remaining = size - 18;
+    const unsigned char *p = buffer + 18;
+    for (int s = 0; s < 2; s++) {
+        sqlite3_int64 first = (sqlite3_int64)get_uint64(p);
+        sqlite3_uint64 count = get_uint64(p + 8);
+        if (remaining < 16 || first < -max_index || first > max_index || count > (sqlite3_uint64)max_index ||
+            (sqlite3_int64)count * 8 > remaining - 16)
+            return SQLITE_ERROR;
+        for (sqlite3_uint64 i = 0; i < count; i++) {
+            if (get_uint64(p + 16 + i * 8) > (sqlite3_uint64)LLONG_MAX)
+                return SQLITE_ERROR;
+        }
+        remaining -= 16 + (sqlite3_int64)count * 8;
+        p += 16 + count * 8;
+    }
+    if (remaining != 0)
+        return SQLITE_ERROR;
+
+    sketch->zero_count += sign * (sqlite3_int64)get_uint64(buffer + 10);
+    SketchStore *stores[2] = {&sketch->negative, &sketch->positive};
+    p = buffer + 18;
+    for (int s = 0; s < 2; s++) {
+        int first = (int)(sqlite3_int64)get_uint64(p);
+        int count = (int)get_uint64(p + 8);
+        p += 16;
+        for (int i = 0; i < count; i++, p += 8) {
+            sqlite3_int64 bucket_count = (sqlite3_int64)get_uint64(p);
+            if (bucket_count == 0)
+                continue;
+            int rc = add_to_sketch_store(stores[s], first + i, sign * bucket_count);
+            if (rc != SQLITE_OK)
+                return rc;
+        }
+    }
+    return SQLITE_OK;
+}
+
+/**
+ * @brief Frees the buckets of a quantile sketch, leaving an empty sketch.
+ * @param sketch The sketch.
+ */
+static void free_quantile_sketch(QuantileSketchData *sketch) {
+    sqlite3_free(sketch->negative.counts);
+    sqlite3_free(sketch->positive.counts);
+    memset(&sketch->negative, 0, sizeof(sketch->negative));
+    memset(&sketch->positive, 0, sizeof(sketch->positive));
+    sketch->zero_count = 0;
+}
+
+/**
+ * @brief Shared "value"/"final" function of `rolling_min`, `rolling_max` and `rolling_range`.
  * @param context The SQLite function context.
- * @param func The specific statistical function to call (e.g., calculate_stddev_sample).
- * @param min_count The minimum number of data points required for the calculation.
+ * @param kind The result to compute.
+ * @param is_final Non-zero when called as xFinal, to release the deques.
  */
-static void stats_value_helper(sqlite3_context *context, stats_func func, int min_count) {
-    WindowStatsData *ctx = (WindowStatsData *)sqlite3_aggregate_context(context, 0);
-    if (!ctx || !ctx->values || ctx->count < (size_t)min_count) {
+static void rolling_extrema_helper(sqlite3_context *context, ExtremaKind kind, int is_final) {
+    RollingExtremaData *ctx = (RollingExtremaData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->count == 0 || ctx->min_deque.count == 0 || ctx->max_deque.count == 0) {
         sqlite3_result_null(context);
-        return;
+    } else {
+        double min = get_circular_value(&ctx->min_deque, 0);
+        double max = get_circular_value(&ctx->max_deque, 0);
+        if (kind == EXTREMA_MIN)
+            sqlite3_result_double(context, min);
+        else if (kind == EXTREMA_MAX)
+            sqlite3_result_double(context, max);
+        else
+            set_result(context, max - min);
+    }
+
+    if (is_final && ctx) {
+        StatsBufferPool *pool = (StatsBufferPool *)sqlite3_user_data(context);
+        free_circular_buffer(&ctx->min_deque, pool);
+        free_circular_buffer(&ctx->max_deque, pool);
     }
-    set_result(context, func(ctx));
 }
 
 /**
- * @brief Generic "final" function for statistical calculations.
+ * @brief Appends a value to a monotonic deque.
+ *
+ * Candidates at the tail that the new value supersedes (greater values for a
+ * minimum deque, smaller ones for a maximum deque) are dropped first. Equal values
+ * are kept, so that each departing copy finds its own entry.
+ * @param deque The deque.
+ * @param value The value.
+ * @param keep_max Non-zero for a maximum deque, zero for a minimum deque.
+ * @param pool The connection's buffer pool, or NULL.
+ * @return SQLITE_OK on success, SQLITE_TOOBIG or SQLITE_NOMEM if the deque could not grow.
+ */
+static int push_to_monotonic_deque(StatsRingBuffer *deque, double value, int keep_max, StatsBufferPool *pool) {
+    while (deque->count > 0) {
+        double last = get_circular_value(deque, deque->count - 1);
+        if (keep_max ? last >= value : last <= value)
+            break;
+        remove_last_from_circular_buffer(deque);
+    }
+    if (deque->count == deque->capacity) {
+        int rc = grow_circular_buffer(deque, pool, 0); // The head is returned as a result.
+        if (rc != SQLITE_OK)
+            return rc;
+    }
+    add_to_circular_buffer(deque, value);
+    return SQLITE_OK;
+}
+
+/**
+ * @brief Shared "value"/"final" function of `mad` and `mad_normal`.
  *
- * This function calculates the final result for an aggregate. Memory is cleaned
- * up by the xDestroy callback, not here, to ensure it's freed correctly even
- * if the query is aborted.
+ * Two selection passes over the frame's values: the first finds the median, then
+ * every value is replaced by its absolute deviation from it, and the second finds
+ * the median of those. Both medians interpolate for even counts, like `median`.
  * @param context The SQLite function context.
- * @param func The specific statistical function to call.
- * @param min_count The minimum number of data points required.
+ * @param scale The factor to multiply the median absolute deviation by.
+ * @param is_final Non-zero when called as xFinal; the frame buffer is then released.
  */
-static void stats_final_helper(sqlite3_context *context, stats_func func, int min_count) {
-    WindowStatsData *ctx = (WindowStatsData *)sqlite3_aggregate_context(context, 0);
-    if (ctx && ctx->values && ctx->count >= (size_t)min_count) {
-        set_result(context, func(ctx));
+static void mad_result_helper(sqlite3_context *context, double scale, int is_final) {
+    QuantileData *ctx = (QuantileData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || ctx->ring.count == 0) {
+        sqlite3_result_null(context);
+        if (ctx && is_final)
+            free_circular_buffer(&ctx->ring, (StatsBufferPool *)sqlite3_user_data(context));
+        return;
+    }
+
+    size_t n = ctx->ring.count;
+    double *scratch;
+    double *values = get_contiguous_values(&ctx->ring, is_final, &scratch);
+    if (values) {
+        size_t ranks[2] = {(n - 1) / 2, n / 2};
+        size_t rank_count = ranks[0] == ranks[1] ? 1 : 2;
+        select_ranks(values, 0, n, ranks, rank_count);
+        double median = get_selected_quantile(values, n, 0.5, QUANTILE_CONTINUOUS);
+        for (size_t i = 0; i < n; i++)
+            values[i] = fabs(values[i] - median);
+        select_ranks(values, 0, n, ranks, rank_count);
+        set_result(context, scale * get_selected_quantile(values, n, 0.5, QUANTILE_CONTINUOUS));
     } else {
+        sqlite3_result_error_nomem(context);
+    }
+
+    sqlite3_free(scratch);
+    if (is_final)
+        free_circular_buffer(&ctx->ring, (StatsBufferPool *)sqlite3_user_data(context));
+}
+
+/**
+ * @brief Shared "value"/"final" function of `rolling_mad` and `rolling_mad_normal`.
+ *
+ * Finds the median in the order statistic tree and then the middle absolute
+ * deviations without materializing them (see `select_deviation_from_tree`).
+ * @param context The SQLite function context.
+ * @param scale The factor to multiply the median absolute deviation by.
+ * @param is_final Non-zero when called as xFinal, to free the tree.
+ */
+static void rolling_mad_helper(sqlite3_context *context, double scale, int is_final) {
+    RollingQuantileData *ctx = (RollingQuantileData *)sqlite3_aggregate_context(context, 0);
+    if (!ctx || !ctx->tree.root) {
         sqlite3_result_null(context);
+    } else {
+        size_t n = ctx->tree.nodes[ctx->tree.root].size;
+        double median = get_tree_quantile(&ctx->tree, 0.5);
+        double mad = select_deviation_from_tree(&ctx->tree, median, n / 2, (n - 1) / 2);
+        if (n % 2 == 0)
+            mad = 0.5 * (mad + select_deviation_from_tree(&ctx->tree, median, n / 2, n / 2));
+        set_result(context, scale * mad);
+    }
+
+    if (is_final && ctx)
+        free_tree(&ctx->tree);
+}
+
+// --- Configuration ---
+
+/**
+ * @brief Reads or changes a per-connection setting of the extension.
+ *
+ * `stats_config(key)` returns the current value of a setting and
+ * `stats_config(key, value)` changes it and returns the new value. The keys are
+ * `max_buffer_size`, the maximum size in bytes of the frame buffer of one buffered
+ * aggregate context (0 for no limit), `mmap_spill_size`, the buffer size in bytes
+ * from which frame buffers are backed by a memory-mapped temporary file (0 to never spill),
+ * and `float32_buffers`, non-zero to store the values of new re-summing frame buffers
+ * as floats.
+ * @param context The SQLite function context. Its user data is the connection's buffer pool.
+ * @param argc The number of arguments.
+ * @param argv The argument values: the key and optionally the new value.
+ */
+static void stats_config(sqlite3_context *context, int argc, sqlite3_value **argv) {
+    StatsBufferPool *pool = (StatsBufferPool *)sqlite3_user_data(context);
+    if (argc != 1 && argc != 2) {
+        sqlite3_result_error(context, "stats_config requires 1 or 2 arguments", -1);
+        return;
+    }
+
+    const char *key = (const char *)sqlite3_value_text(argv[0]);
+    sqlite3_int64 *setting;
+    if (key && sqlite3_stricmp(key, "max_buffer_size") == 0) {
+        setting = &pool->max_buffer_size;
+    } else if (key && sqlite3_stricmp(key, "mmap_spill_size") == 0) {
+        setting = &pool->mmap_spill_size;
+    } else if (key && sqlite3_stricmp(key, "float32_buffers") == 0) {
+        setting = &pool->float32_buffers;
+    } else {
+        sqlite3_result_error(context, "Unknown stats_config key", -1);
+        return;
+    }
+
+    if (argc == 2) {
+        if (sqlite3_value_type(argv[1]) != SQLITE_INTEGER || sqlite3_value_int64(argv[1]) < 0) {
+            sqlite3_result_error(context, "stats_config value must be a non-negative integer", -1);
+            return;
+        }
+        *setting = sqlite3_value_int64(argv[1]);
     }
+    sqlite3_result_int64(context, *setting);
 }
 
 // --- Extension Initialization ---
 
+/**
+ * @brief Registers a single function of a group under the given name.
+ * @param db The database connection.
+ * @param name The name to register.
+ * @param group The function group providing the callbacks.
+ * @return SQLITE_OK on success, or an error code on failure.
+ */
+static int create_stats_function(sqlite3 *db, const char *name, const StatsFunctionGroup *group) {
+    int flags = SQLITE_UTF8 | SQLITE_DETERMINISTIC | SQLITE_INNOCUOUS;
+    if (group->xFunc)
+        return sqlite3_create_function(db, name, group->arg_count, flags, 0, group->xFunc, NULL, NULL);
+    if (!group->pool)
+        return sqlite3_create_window_function(db, name, group->arg_count, flags, 0, group->xStep, group->xFinal, group->xValue, group->xInverse, NULL);
+    // Each registration owns a reference. SQLite calls the destructor when the function is
+    // replaced or the connection closes, and also when registration fails.
+    group->pool->ref_count++;
+    return sqlite3_create_window_function(db, name, group->arg_count, flags, group->pool, group->xStep, group->xFinal, group->xValue, group->xInverse, release_buffer_pool);
+}
+
 /**
  * @brief Helper function to register a group of statistical functions (lowercase and uppercase).
  * @param db The database connection.
@@ -405,17 +5103,16 @@ static void stats_final_helper(sqlite3_context *context, stats_func func, int mi
  */
 static int register_stats_function_group(sqlite3 *db, const StatsFunctionGroup *group) {
     int rc = SQLITE_OK;
-    int flags = SQLITE_UTF8 | SQLITE_DETERMINISTIC | SQLITE_INNOCUOUS;
 
     for (size_t i = 0; i < group->name_count; i++) {
         const char *name = group->names[i];
-        rc = sqlite3_create_window_function(db, name, 1, flags, 0, stats_step, group->xFinal, group->xValue, stats_inverse, stats_destroy);
+        rc = create_stats_function(db, name, group);
         if (rc != SQLITE_OK)
             return rc;
 
         // Create and register the uppercase version.
         size_t name_len = strlen(name);
-        char *upper_name = (char *)malloc(name_len + 1);
+        char *upper_name = (char *)sqlite3_malloc64(name_len + 1);
         if (!upper_name)
             return SQLITE_NOMEM;
         for (size_t j = 0; j < name_len; j++) {
@@ -423,9 +5120,9 @@ static int register_stats_function_group(sqlite3 *db, const StatsFunctionGroup *
         }
         upper_name[name_len] = '\0';
 
-        rc = sqlite3_create_window_function(db, upper_name, 1, flags, 0, stats_step, group->xFinal, group->xValue, stats_inverse, stats_destroy);
+        rc = create_stats_function(db, upper_name, group);
         if (upper_name) {
-            free(upper_name);
+            sqlite3_free(upper_name);
             upper_name = NULL;
         }
         if (rc != SQLITE_OK)
@@ -449,27 +5146,216 @@ int sqlite3_extension_init(sqlite3 *db, char **pzErrMsg, const sqlite3_api_routi
     int rc = SQLITE_OK;
     SQLITE_EXTENSION_INIT2(pApi);
 
+    // The buffer pool shared by this connection's buffered functions. The reference held
+    // here is dropped once all functions are registered.
+    StatsBufferPool *pool = (StatsBufferPool *)sqlite3_malloc64(sizeof(StatsBufferPool));
+    if (!pool)
+        return SQLITE_NOMEM;
+    memset(pool, 0, sizeof(StatsBufferPool));
+    pool->ref_count = 1;
+    pool->max_buffer_size = MAX_BUFFER_SIZE;
+    pool->mmap_spill_size = MMAP_SPILL_SIZE;
+    pool->float32_buffers = FLOAT32_BUFFERS;
+
     // Define the names and aliases for each statistical function.
     const char *stddev_samp_names[] = {"stddev_samp", "stddev_sample", "stdev_samp", "stdev_sample", "stddev", "stdev", "std_dev", "standard_deviation"};
     const char *stddev_pop_names[] = {"stddev_pop", "stddev_population", "stdev_pop", "stdev_population"};
     const char *variance_samp_names[] = {"variance_samp", "variance_sample", "var_samp", "var_sample", "variance", "var"};
     const char *variance_pop_names[] = {"variance_pop", "variance_population", "var_pop", "var_population"};
+    const char *stddev_samp_resum_names[] = {"stddev_samp_resum", "stddev_resum"};
+    const char *stddev_pop_resum_names[] = {"stddev_pop_resum"};
+    const char *variance_samp_resum_names[] = {"variance_samp_resum", "variance_resum"};
+    const char *variance_pop_resum_names[] = {"variance_pop_resum"};
+    const char *stddev_samp_precise_names[] = {"stddev_samp_precise", "stddev_precise"};
+    const char *stddev_pop_precise_names[] = {"stddev_pop_precise"};
+    const char *variance_samp_precise_names[] = {"variance_samp_precise", "variance_precise"};
+    const char *variance_pop_precise_names[] = {"variance_pop_precise"};
+    const char *ew_variance_samp_names[] = {"ew_variance_samp", "ew_variance", "ew_var"};
+    const char *ew_variance_pop_names[] = {"ew_variance_pop"};
+    const char *ew_stddev_samp_names[] = {"ew_stddev_samp", "ew_stddev"};
+    const char *ew_stddev_pop_names[] = {"ew_stddev_pop"};
+    const char *ew_variance_samp_halflife_names[] = {"ew_variance_samp_halflife", "ew_variance_halflife"};
+    const char *ew_variance_pop_halflife_names[] = {"ew_variance_pop_halflife"};
+    const char *ew_stddev_samp_halflife_names[] = {"ew_stddev_samp_halflife", "ew_stddev_halflife"};
+    const char *ew_stddev_pop_halflife_names[] = {"ew_stddev_pop_halflife"};
+    const char *decayed_variance_samp_names[] = {"decayed_variance_samp", "decayed_variance"};
+    const char *decayed_variance_pop_names[] = {"decayed_variance_pop"};
+    const char *decayed_stddev_samp_names[] = {"decayed_stddev_samp", "decayed_stddev"};
+    const char *decayed_stddev_pop_names[] = {"decayed_stddev_pop"};
+    const char *time_weighted_avg_names[] = {"time_weighted_avg"};
+    const char *time_weighted_variance_names[] = {"time_weighted_variance"};
+    const char *time_weighted_stddev_names[] = {"time_weighted_stddev"};
+    const char *covar_samp_names[] = {"covar_samp"};
+    const char *covar_pop_names[] = {"covar_pop"};
+    const char *corr_names[] = {"corr"};
+    const char *regr_count_names[] = {"regr_count"};
+    const char *regr_slope_names[] = {"regr_slope"};
+    const char *regr_intercept_names[] = {"regr_intercept"};
+    const char *regr_r2_names[] = {"regr_r2"};
+    const char *regr_avgx_names[] = {"regr_avgx"};
+    const char *regr_avgy_names[] = {"regr_avgy"};
+    const char *regr_sxx_names[] = {"regr_sxx"};
+    const char *regr_syy_names[] = {"regr_syy"};
+    const char *regr_sxy_names[] = {"regr_sxy"};
+    const char *regr_residual_stderr_names[] = {"regr_residual_stderr"};
+    const char *covar_samp_resum_names[] = {"covar_samp_resum"};
+    const char *covar_pop_resum_names[] = {"covar_pop_resum"};
+    const char *corr_resum_names[] = {"corr_resum"};
+    const char *regr_slope_resum_names[] = {"regr_slope_resum"};
+    const char *regr_intercept_resum_names[] = {"regr_intercept_resum"};
+    const char *regr_r2_resum_names[] = {"regr_r2_resum"};
+    const char *regr_avgx_resum_names[] = {"regr_avgx_resum"};
+    const char *regr_avgy_resum_names[] = {"regr_avgy_resum"};
+    const char *regr_sxx_resum_names[] = {"regr_sxx_resum"};
+    const char *regr_syy_resum_names[] = {"regr_syy_resum"};
+    const char *regr_sxy_resum_names[] = {"regr_sxy_resum"};
+    const char *regr_residual_stderr_resum_names[] = {"regr_residual_stderr_resum"};
+    const char *stddev_state_names[] = {"stddev_state"};
+    const char *stddev_merge_names[] = {"stddev_merge"};
+    const char *stddev_samp_finalize_names[] = {"stddev_samp_finalize", "stddev_finalize"};
+    const char *stddev_pop_finalize_names[] = {"stddev_pop_finalize"};
+    const char *variance_samp_finalize_names[] = {"variance_samp_finalize", "variance_finalize"};
+    const char *variance_pop_finalize_names[] = {"variance_pop_finalize"};
+    const char *stats_summary_names[] = {"stats_summary"};
+    const char *stats_summary_blob_names[] = {"stats_summary_blob"};
+    const char *summary_count_names[] = {"summary_count"};
+    const char *summary_mean_names[] = {"summary_mean"};
+    const char *summary_min_names[] = {"summary_min"};
+    const char *summary_max_names[] = {"summary_max"};
+    const char *summary_variance_samp_names[] = {"summary_variance_samp", "summary_variance"};
+    const char *summary_variance_pop_names[] = {"summary_variance_pop"};
+    const char *summary_stddev_samp_names[] = {"summary_stddev_samp", "summary_stddev"};
+    const char *summary_stddev_pop_names[] = {"summary_stddev_pop"};
+    const char *summary_stderr_names[] = {"summary_stderr"};
+    const char *summary_cv_names[] = {"summary_cv"};
+    const char *stddev_cols_names[] = {"stddev_cols", "stddev_samp_cols"};
+    const char *median_names[] = {"median"};
+    const char *percentile_cont_names[] = {"percentile_cont"};
+    const char *percentile_disc_names[] = {"percentile_disc"};
+    const char *quantiles_names[] = {"quantiles"};
+    const char *rolling_median_names[] = {"rolling_median"};
+    const char *rolling_quantile_names[] = {"rolling_quantile"};
+    const char *approx_median_names[] = {"approx_median"};
+    const char *approx_quantile_names[] = {"approx_quantile"};
+    const char *quantile_sketch_names[] = {"quantile_sketch"};
+    const char *quantile_sketch_merge_names[] = {"quantile_sketch_merge"};
+    const char *quantile_sketch_finalize_names[] = {"quantile_sketch_finalize"};
+    const char *rolling_min_names[] = {"rolling_min"};
+    const char *rolling_max_names[] = {"rolling_max"};
+    const char *rolling_range_names[] = {"rolling_range"};
+    const char *mad_names[] = {"mad", "median_absolute_deviation"};
+    const char *mad_normal_names[] = {"mad_normal"};
+    const char *rolling_mad_names[] = {"rolling_mad"};
+    const char *rolling_mad_normal_names[] = {"rolling_mad_normal"};
 
     // Define the groups of functions to be registered.
     StatsFunctionGroup functions_to_register[] = {
-        {stddev_samp_names, sizeof(stddev_samp_names) / sizeof(stddev_samp_names[0]), stddev_samp_value, stddev_samp_final},
-        {stddev_pop_names, sizeof(stddev_pop_names) / sizeof(stddev_pop_names[0]), stddev_pop_value, stddev_pop_final},
-        {variance_samp_names, sizeof(variance_samp_names) / sizeof(variance_samp_names[0]), variance_samp_value, variance_samp_final},
-        {variance_pop_names, sizeof(variance_pop_names) / sizeof(variance_pop_names[0]), variance_pop_value, variance_pop_final}};
+        {stddev_samp_names, sizeof(stddev_samp_names) / sizeof(stddev_samp_names[0]), 1, NULL, stats_step, stats_inverse, stddev_samp_value, stddev_samp_final, NULL},
+        {stddev_pop_names, sizeof(stddev_pop_names) / sizeof(stddev_pop_names[0]), 1, NULL, stats_step, stats_inverse, stddev_pop_value, stddev_pop_final, NULL},
+        {variance_samp_names, sizeof(variance_samp_names) / sizeof(variance_samp_names[0]), 1, NULL, stats_step, stats_inverse, variance_samp_value, variance_samp_final, NULL},
+        {variance_pop_names, sizeof(variance_pop_names) / sizeof(variance_pop_names[0]), 1, NULL, stats_step, stats_inverse, variance_pop_value, variance_pop_final, NULL},
+        {stddev_samp_resum_names, sizeof(stddev_samp_resum_names) / sizeof(stddev_samp_resum_names[0]), 1, NULL, resum_step, resum_inverse, stddev_samp_value, stddev_samp_resum_final, pool},
+        {stddev_pop_resum_names, sizeof(stddev_pop_resum_names) / sizeof(stddev_pop_resum_names[0]), 1, NULL, resum_step, resum_inverse, stddev_pop_value, stddev_pop_resum_final, pool},
+        {variance_samp_resum_names, sizeof(variance_samp_resum_names) / sizeof(variance_samp_resum_names[0]), 1, NULL, resum_step, resum_inverse, variance_samp_value, variance_samp_resum_final, pool},
+        {variance_pop_resum_names, sizeof(variance_pop_resum_names) / sizeof(variance_pop_resum_names[0]), 1, NULL, resum_step, resum_inverse, variance_pop_value, variance_pop_resum_final, pool},
+        {stddev_samp_precise_names, sizeof(stddev_samp_precise_names) / sizeof(stddev_samp_precise_names[0]), 1, NULL, precise_step, precise_inverse, stddev_samp_precise_value, stddev_samp_precise_final, NULL},
+        {stddev_pop_precise_names, sizeof(stddev_pop_precise_names) / sizeof(stddev_pop_precise_names[0]), 1, NULL, precise_step, precise_inverse, stddev_pop_precise_value, stddev_pop_precise_final, NULL},
+        {variance_samp_precise_names, sizeof(variance_samp_precise_names) / sizeof(variance_samp_precise_names[0]), 1, NULL, precise_step, precise_inverse, variance_samp_precise_value, variance_samp_precise_final, NULL},
+        {variance_pop_precise_names, sizeof(variance_pop_precise_names) / sizeof(variance_pop_precise_names[0]), 1, NULL, precise_step, precise_inverse, variance_pop_precise_value, variance_pop_precise_final, NULL},
+        {ew_variance_samp_names, sizeof(ew_variance_samp_names) / sizeof(ew_variance_samp_names[0]), 2, NULL, ew_alpha_step, ew_inverse, ew_variance_samp_value, ew_variance_samp_value, NULL},
+        {ew_variance_pop_names, sizeof(ew_variance_pop_names) / sizeof(ew_variance_pop_names[0]), 2, NULL, ew_alpha_step, ew_inverse, ew_variance_pop_value, ew_variance_pop_value, NULL},
+        {ew_stddev_samp_names, sizeof(ew_stddev_samp_names) / sizeof(ew_stddev_samp_names[0]), 2, NULL, ew_alpha_step, ew_inverse, ew_stddev_samp_value, ew_stddev_samp_value, NULL},
+        {ew_stddev_pop_names, sizeof(ew_stddev_pop_names) / sizeof(ew_stddev_pop_names[0]), 2, NULL, ew_alpha_step, ew_inverse, ew_stddev_pop_value, ew_stddev_pop_value, NULL},
+        {ew_variance_samp_halflife_names, sizeof(ew_variance_samp_halflife_names) / sizeof(ew_variance_samp_halflife_names[0]), 2, NULL, ew_halflife_step, ew_inverse, ew_variance_samp_value, ew_variance_samp_value, NULL},
+        {ew_variance_pop_halflife_names, sizeof(ew_variance_pop_halflife_names) / sizeof(ew_variance_pop_halflife_names[0]), 2, NULL, ew_halflife_step, ew_inverse, ew_variance_pop_value, ew_variance_pop_value, NULL},
+        {ew_stddev_samp_halflife_names, sizeof(ew_stddev_samp_halflife_names) / sizeof(ew_stddev_samp_halflife_names[0]), 2, NULL, ew_halflife_step, ew_inverse, ew_stddev_samp_value, ew_stddev_samp_value, NULL},
+        {ew_stddev_pop_halflife_names, sizeof(ew_stddev_pop_halflife_names) / sizeof(ew_stddev_pop_halflife_names[0]), 2, NULL, ew_halflife_step, ew_inverse, ew_stddev_pop_value, ew_stddev_pop_value, NULL},
+        {decayed_variance_samp_names, sizeof(decayed_variance_samp_names) / sizeof(decayed_variance_samp_names[0]), 3, NULL, decayed_step, decayed_inverse, ew_variance_samp_value, ew_variance_samp_value, NULL},
+        {decayed_variance_pop_names, sizeof(decayed_variance_pop_names) / sizeof(decayed_variance_pop_names[0]), 3, NULL, decayed_step, decayed_inverse, ew_variance_pop_value, ew_variance_pop_value, NULL},
+        {decayed_stddev_samp_names, sizeof(decayed_stddev_samp_names) / sizeof(decayed_stddev_samp_names[0]), 3, NULL, decayed_step, decayed_inverse, ew_stddev_samp_value, ew_stddev_samp_value, NULL},
+        {decayed_stddev_pop_names, sizeof(decayed_stddev_pop_names) / sizeof(decayed_stddev_pop_names[0]), 3, NULL, decayed_step, decayed_inverse, ew_stddev_pop_value, ew_stddev_pop_value, NULL},
+        {time_weighted_avg_names, sizeof(time_weighted_avg_names) / sizeof(time_weighted_avg_names[0]), 2, NULL, time_weighted_step, time_weighted_inverse, time_weighted_avg_value, time_weighted_avg_final, pool},
+        {time_weighted_variance_names, sizeof(time_weighted_variance_names) / sizeof(time_weighted_variance_names[0]), 2, NULL, time_weighted_step, time_weighted_inverse, ew_variance_pop_value, time_weighted_variance_final, pool},
+        {time_weighted_stddev_names, sizeof(time_weighted_stddev_names) / sizeof(time_weighted_stddev_names[0]), 2, NULL, time_weighted_step, time_weighted_inverse, ew_stddev_pop_value, time_weighted_stddev_final, pool},
+        {covar_samp_names, sizeof(covar_samp_names) / sizeof(covar_samp_names[0]), 2, NULL, paired_step, paired_inverse, covar_samp_value, covar_samp_value, NULL},
+        {covar_pop_names, sizeof(covar_pop_names) / sizeof(covar_pop_names[0]), 2, NULL, paired_step, paired_inverse, covar_pop_value, covar_pop_value, NULL},
+        {corr_names, sizeof(corr_names) / sizeof(corr_names[0]), 2, NULL, paired_step, paired_inverse, corr_value, corr_value, NULL},
+        {regr_count_names, sizeof(regr_count_names) / sizeof(regr_count_names[0]), 2, NULL, paired_step, paired_inverse, regr_count_value, regr_count_value, NULL},
+        {regr_slope_names, sizeof(regr_slope_names) / sizeof(regr_slope_names[0]), 2, NULL, paired_step, paired_inverse, regr_slope_value, regr_slope_value, NULL},
+        {regr_intercept_names, sizeof(regr_intercept_names) / sizeof(regr_intercept_names[0]), 2, NULL, paired_step, paired_inverse, regr_intercept_value, regr_intercept_value, NULL},
+        {regr_r2_names, sizeof(regr_r2_names) / sizeof(regr_r2_names[0]), 2, NULL, paired_step, paired_inverse, regr_r2_value, regr_r2_value, NULL},
+        {regr_avgx_names, sizeof(regr_avgx_names) / sizeof(regr_avgx_names[0]), 2, NULL, paired_step, paired_inverse, regr_avgx_value, regr_avgx_value, NULL},
+        {regr_avgy_names, sizeof(regr_avgy_names) / sizeof(regr_avgy_names[0]), 2, NULL, paired_step, paired_inverse, regr_avgy_value, regr_avgy_value, NULL},
+        {regr_sxx_names, sizeof(regr_sxx_names) / sizeof(regr_sxx_names[0]), 2, NULL, paired_step, paired_inverse, regr_sxx_value, regr_sxx_value, NULL},
+        {regr_syy_names, sizeof(regr_syy_names) / sizeof(regr_syy_names[0]), 2, NULL, paired_step, paired_inverse, regr_syy_value, regr_syy_value, NULL},
+        {regr_sxy_names, sizeof(regr_sxy_names) / sizeof(regr_sxy_names[0]), 2, NULL, paired_step, paired_inverse, regr_sxy_value, regr_sxy_value, NULL},
+        {regr_residual_stderr_names, sizeof(regr_residual_stderr_names) / sizeof(regr_residual_stderr_names[0]), 2, NULL, paired_step, paired_inverse, regr_residual_stderr_value, regr_residual_stderr_value, NULL},
+        {covar_samp_resum_names, sizeof(covar_samp_resum_names) / sizeof(covar_samp_resum_names[0]), 2, NULL, paired_resum_step, paired_resum_inverse, covar_samp_value, covar_samp_resum_final, pool},
+        {covar_pop_resum_names, sizeof(covar_pop_resum_names) / sizeof(covar_pop_resum_names[0]), 2, NULL, paired_resum_step, paired_resum_inverse, covar_pop_value, covar_pop_resum_final, pool},
+        {corr_resum_names, sizeof(corr_resum_names) / sizeof(corr_resum_names[0]), 2, NULL, paired_resum_step, paired_resum_inverse, corr_value, corr_resum_final, pool},
+        {regr_slope_resum_names, sizeof(regr_slope_resum_names) / sizeof(regr_slope_resum_names[0]), 2, NULL, paired_resum_step, paired_resum_inverse, regr_slope_value, regr_slope_resum_final, pool},
+        {regr_intercept_resum_names, sizeof(regr_intercept_resum_names) / sizeof(regr_intercept_resum_names[0]), 2, NULL, paired_resum_step, paired_resum_inverse, regr_intercept_value, regr_intercept_resum_final, pool},
+        {regr_r2_resum_names, sizeof(regr_r2_resum_names) / sizeof(regr_r2_resum_names[0]), 2, NULL, paired_resum_step, paired_resum_inverse, regr_r2_value, regr_r2_resum_final, pool},
+        {regr_avgx_resum_names, sizeof(regr_avgx_resum_names) / sizeof(regr_avgx_resum_names[0]), 2, NULL, paired_resum_step, paired_resum_inverse, regr_avgx_value, regr_avgx_resum_final, pool},
+        {regr_avgy_resum_names, sizeof(regr_avgy_resum_names) / sizeof(regr_avgy_resum_names[0]), 2, NULL, paired_resum_step, paired_resum_inverse, regr_avgy_value, regr_avgy_resum_final, pool},
+        {regr_sxx_resum_names, sizeof(regr_sxx_resum_names) / sizeof(regr_sxx_resum_names[0]), 2, NULL, paired_resum_step, paired_resum_inverse, regr_sxx_value, regr_sxx_resum_final, pool},
+        {regr_syy_resum_names, sizeof(regr_syy_resum_names) / sizeof(regr_syy_resum_names[0]), 2, NULL, paired_resum_step, paired_resum_inverse, regr_syy_value, regr_syy_resum_final, pool},
+        {regr_sxy_resum_names, sizeof(regr_sxy_resum_names) / sizeof(regr_sxy_resum_names[0]), 2, NULL, paired_resum_step, paired_resum_inverse, regr_sxy_value, regr_sxy_resum_final, pool},
+        {regr_residual_stderr_resum_names, sizeof(regr_residual_stderr_resum_names) / sizeof(regr_residual_stderr_resum_names[0]), 2, NULL, paired_resum_step, paired_resum_inverse, regr_residual_stderr_value, regr_residual_stderr_resum_final, pool},
+        {stddev_state_names, sizeof(stddev_state_names) / sizeof(stddev_state_names[0]), 1, NULL, stats_step, stats_inverse, state_value, state_final, NULL},
+        {stddev_merge_names, sizeof(stddev_merge_names) / sizeof(stddev_merge_names[0]), 1, NULL, merge_step, merge_inverse, state_value, state_final, NULL},
+        {stddev_samp_finalize_names, sizeof(stddev_samp_finalize_names) / sizeof(stddev_samp_finalize_names[0]), 1, stddev_samp_finalize, NULL, NULL, NULL, NULL, NULL},
+        {stddev_pop_finalize_names, sizeof(stddev_pop_finalize_names) / sizeof(stddev_pop_finalize_names[0]), 1, stddev_pop_finalize, NULL, NULL, NULL, NULL, NULL},
+        {variance_samp_finalize_names, sizeof(variance_samp_finalize_names) / sizeof(variance_samp_finalize_names[0]), 1, variance_samp_finalize, NULL, NULL, NULL, NULL, NULL},
+        {variance_pop_finalize_names, sizeof(variance_pop_finalize_names) / sizeof(variance_pop_finalize_names[0]), 1, variance_pop_finalize, NULL, NULL, NULL, NULL, NULL},
+        {stats_summary_names, sizeof(stats_summary_names) / sizeof(stats_summary_names[0]), 1, NULL, summary_step, summary_inverse, summary_json_value, summary_json_final, pool},
+        {stats_summary_blob_names, sizeof(stats_summary_blob_names) / sizeof(stats_summary_blob_names[0]), 1, NULL, summary_step, summary_inverse, summary_blob_value, summary_blob_final, pool},
+        {summary_count_names, sizeof(summary_count_names) / sizeof(summary_count_names[0]), 1, summary_count, NULL, NULL, NULL, NULL, NULL},
+        {summary_mean_names, sizeof(summary_mean_names) / sizeof(summary_mean_names[0]), 1, summary_mean, NULL, NULL, NULL, NULL, NULL},
+        {summary_min_names, sizeof(summary_min_names) / sizeof(summary_min_names[0]), 1, summary_min, NULL, NULL, NULL, NULL, NULL},
+        {summary_max_names, sizeof(summary_max_names) / sizeof(summary_max_names[0]), 1, summary_max, NULL, NULL, NULL, NULL, NULL},
+        {summary_variance_samp_names, sizeof(summary_variance_samp_names) / sizeof(summary_variance_samp_names[0]), 1, summary_variance_samp, NULL, NULL, NULL, NULL, NULL},
+        {summary_variance_pop_names, sizeof(summary_variance_pop_names) / sizeof(summary_variance_pop_names[0]), 1, summary_variance_pop, NULL, NULL, NULL, NULL, NULL},
+        {summary_stddev_samp_names, sizeof(summary_stddev_samp_names) / sizeof(summary_stddev_samp_names[0]), 1, summary_stddev_samp, NULL, NULL, NULL, NULL, NULL},
+        {summary_stddev_pop_names, sizeof(summary_stddev_pop_names) / sizeof(summary_stddev_pop_names[0]), 1, summary_stddev_pop, NULL, NULL, NULL, NULL, NULL},
+        {summary_stderr_names, sizeof(summary_stderr_names) / sizeof(summary_stderr_names[0]), 1, summary_stderr, NULL, NULL, NULL, NULL, NULL},
+        {summary_cv_names, sizeof(summary_cv_names) / sizeof(summary_cv_names[0]), 1, summary_cv, NULL, NULL, NULL, NULL, NULL},
+        {stddev_cols_names, sizeof(stddev_cols_names) / sizeof(stddev_cols_names[0]), -1, NULL, stddev_cols_step, stddev_cols_inverse, stddev_cols_value, stddev_cols_final, NULL},
+        {median_names, sizeof(median_names) / sizeof(median_names[0]), 1, NULL, quantile_step, quantile_inverse, percentile_cont_value, percentile_cont_final, pool},
+        {percentile_cont_names, sizeof(percentile_cont_names) / sizeof(percentile_cont_names[0]), 2, NULL, quantile_step, quantile_inverse, percentile_cont_value, percentile_cont_final, pool},
+        {percentile_disc_names, sizeof(percentile_disc_names) / sizeof(percentile_disc_names[0]), 2, NULL, quantile_step, quantile_inverse, percentile_disc_value, percentile_disc_final, pool},
+        {quantiles_names, sizeof(quantiles_names) / sizeof(quantiles_names[0]), -1, NULL, quantiles_step, quantile_inverse, quantiles_value, quantiles_final, pool},
+        {rolling_median_names, sizeof(rolling_median_names) / sizeof(rolling_median_names[0]), 1, NULL, rolling_quantile_step, rolling_quantile_inverse, rolling_quantile_value, rolling_quantile_final, pool},
+        {rolling_quantile_names, sizeof(rolling_quantile_names) / sizeof(rolling_quantile_names[0]), 2, NULL, rolling_quantile_step, rolling_quantile_inverse, rolling_quantile_value, rolling_quantile_final, pool},
+        {approx_median_names, sizeof(approx_median_names) / sizeof(approx_median_names[0]), 1, NULL, sketch_step, sketch_inverse, approx_quantile_value, approx_quantile_final, NULL},
+        {approx_quantile_names, sizeof(approx_quantile_names) / sizeof(approx_quantile_names[0]), 2, NULL, sketch_step, sketch_inverse, approx_quantile_value, approx_quantile_final, NULL},
+        {quantile_sketch_names, sizeof(quantile_sketch_names) / sizeof(quantile_sketch_names[0]), 1, NULL, sketch_step, sketch_inverse, sketch_state_value, sketch_state_final, NULL},
+        {quantile_sketch_merge_names, sizeof(quantile_sketch_merge_names) / sizeof(quantile_sketch_merge_names[0]), 1, NULL, sketch_merge_step, sketch_merge_inverse, sketch_state_value, sketch_state_final, NULL},
+        {quantile_sketch_finalize_names, sizeof(quantile_sketch_finalize_names) / sizeof(quantile_sketch_finalize_names[0]), 2, quantile_sketch_finalize, NULL, NULL, NULL, NULL, NULL},
+        {rolling_min_names, sizeof(rolling_min_names) / sizeof(rolling_min_names[0]), 1, NULL, rolling_extrema_step, rolling_extrema_inverse, rolling_min_value, rolling_min_final, pool},
+        {rolling_max_names, sizeof(rolling_max_names) / sizeof(rolling_max_names[0]), 1, NULL, rolling_extrema_step, rolling_extrema_inverse, rolling_max_value, rolling_max_final, pool},
+        {rolling_range_names, sizeof(rolling_range_names) / sizeof(rolling_range_names[0]), 1, NULL, rolling_extrema_step, rolling_extrema_inverse, rolling_range_value, rolling_range_final, pool},
+        {mad_names, sizeof(mad_names) / sizeof(mad_names[0]), 1, NULL, quantile_step, quantile_inverse, mad_value, mad_final, pool},
+        {mad_normal_names, sizeof(mad_normal_names) / sizeof(mad_normal_names[0]), 1, NULL, quantile_step, quantile_inverse, mad_normal_value, mad_normal_final, pool},
+        {rolling_mad_names, sizeof(rolling_mad_names) / sizeof(rolling_mad_names[0]), 1, NULL, rolling_quantile_step, rolling_quantile_inverse, rolling_mad_value, rolling_mad_final, pool},
+        {rolling_mad_normal_names, sizeof(rolling_mad_normal_names) / sizeof(rolling_mad_normal_names[0]), 1, NULL, rolling_quantile_step, rolling_quantile_inverse, rolling_mad_normal_value, rolling_mad_normal_final, pool}};
 
     // Iterate through the groups and register each function and its aliases.
     size_t num_groups = sizeof(functions_to_register) / sizeof(functions_to_register[0]);
     for (size_t i = 0; i < num_groups; i++) {
         rc = register_stats_function_group(db, &functions_to_register[i]);
         if (rc != SQLITE_OK) {
-            return rc;
+            break;
         }
     }
 
+    // `stats_config` changes connection state, so it is neither deterministic nor
+    // innocuous and may only be called directly from top-level SQL.
+    if (rc == SQLITE_OK) {
+        pool->ref_count++;
+        rc = sqlite3_create_function_v2(db, "stats_config", -1, SQLITE_UTF8 | SQLITE_DIRECTONLY, pool, stats_config, NULL, NULL, release_buffer_pool);
+    }
+
+    release_buffer_pool(pool);
     return rc;
 }
\ No newline at end of file
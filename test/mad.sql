@@ -0,0 +1,18 @@
+-- Regression checks for mad, mad_normal, rolling_mad and rolling_mad_normal.
+
+CREATE TABLE t(i INTEGER PRIMARY KEY, v);
+INSERT INTO t(v) VALUES (0.1), (0.2), (0.3), (0.4), (1234567.891);
+
+-- The median is 0.3, and the absolute deviations are 0.2, 0.3 - 0.2, 0, 0.4 - 0.3
+-- and a large one. In doubles, 0.4 - 0.3 is the middle one. The frame buffer must
+-- not round the values to floats.
+SELECT 'float32_buffers enabled', iif(stats_config('float32_buffers', 1) = 1, 'ok', 'FAIL');
+SELECT 'mad ignores float32_buffers',
+       iif(mad(v) = 0.4 - 0.3, 'ok', 'FAIL ' || mad(v)) FROM t;
+SELECT 'mad_normal ignores float32_buffers',
+       iif(mad_normal(v) = (0.4 - 0.3) * 1.4826022185056018, 'ok', 'FAIL ' || mad_normal(v)) FROM t;
+SELECT 'sliding mad agrees with rolling_mad under float32_buffers',
+       iif(count(*) = 0, 'ok', 'FAIL at rows ' || group_concat(i))
+FROM (SELECT i, mad(v) OVER w AS m, rolling_mad(v) OVER w AS r FROM t WINDOW w AS (ORDER BY i ROWS 2 PRECEDING))
+WHERE m IS NOT r;
+SELECT 'float32_buffers disabled', iif(stats_config('float32_buffers', 0) = 0, 'ok', 'FAIL');
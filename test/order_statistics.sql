@@ -0,0 +1,21 @@
+-- Regression checks for median, percentile_cont, percentile_disc and quantiles.
+
+CREATE TABLE t(i INTEGER PRIMARY KEY, v);
+INSERT INTO t(v) VALUES (0.1), (0.2), (0.3), (1234567.891);
+
+-- Order statistics return input values (or interpolate between two of them), so
+-- their frame buffers keep doubles even when float32_buffers is enabled.
+SELECT 'float32_buffers enabled', iif(stats_config('float32_buffers', 1) = 1, 'ok', 'FAIL');
+SELECT 'median ignores float32_buffers',
+       iif(median(v) = (0.2 + 0.3) / 2, 'ok', 'FAIL ' || median(v)) FROM t;
+SELECT 'percentile_disc returns an input value under float32_buffers',
+       iif(percentile_disc(v, 0.4) = 0.2, 'ok', 'FAIL ' || percentile_disc(v, 0.4)) FROM t;
+SELECT 'percentile_cont ignores float32_buffers',
+       iif(percentile_cont(v, 0.5) = (0.2 + 0.3) / 2, 'ok', 'FAIL ' || percentile_cont(v, 0.5)) FROM t;
+SELECT 'quantiles ignores float32_buffers',
+       iif(quantiles(v, 0.0, 1.0) = '[0.1,1234567.891]', 'ok', 'FAIL ' || quantiles(v, 0.0, 1.0)) FROM t;
+SELECT 'sliding percentile_disc returns input values under float32_buffers',
+       iif(count(*) = 0, 'ok', 'FAIL at rows ' || group_concat(i))
+FROM (SELECT i, percentile_disc(v, 0.0) OVER (ORDER BY i ROWS 1 PRECEDING) AS p FROM t) AS r
+WHERE p NOT IN (SELECT v FROM t);
+SELECT 'float32_buffers disabled', iif(stats_config('float32_buffers', 0) = 0, 'ok', 'FAIL');
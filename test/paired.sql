@@ -0,0 +1,39 @@
+-- Regression checks for the paired statistics and their re-summing variants.
+
+-- x is around 0 to 9, except for a few outliers of +-1e12 that enter and leave a
+-- sliding frame of 18 rows. Once they have left, the frames must agree with the
+-- aggregate over the same rows.
+CREATE TABLE p(i INTEGER PRIMARY KEY, y, x);
+WITH RECURSIVE seq(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM seq WHERE i < 400)
+INSERT INTO p SELECT i, ((i * 7919) % 101) / 10.0 + ((i * 104729) % 89) / 100.0,
+                     CASE WHEN i IN (40, 41, 120) THEN 1e12 WHEN i IN (42, 200) THEN -1e12 ELSE ((i * 104729) % 89) / 10.0 END FROM seq;
+
+CREATE TABLE expected AS
+SELECT o.i, (SELECT corr(y, x) FROM p AS q WHERE q.i BETWEEN o.i - 17 AND o.i) AS corr,
+            (SELECT regr_r2(y, x) FROM p AS q WHERE q.i BETWEEN o.i - 17 AND o.i) AS r2,
+            (SELECT regr_intercept(y, x) FROM p AS q WHERE q.i BETWEEN o.i - 17 AND o.i) AS intercept,
+            (SELECT covar_samp(y, x) FROM p AS q WHERE q.i BETWEEN o.i - 17 AND o.i) AS covar
+FROM p AS o;
+
+SELECT 'sliding corr_resum, regr_r2_resum, regr_intercept_resum and covar_samp_resum after outliers left',
+       iif(count(*) = 0, 'ok', 'FAIL at rows ' || group_concat(i))
+FROM (SELECT i, corr_resum(y, x) OVER w AS corr, regr_r2_resum(y, x) OVER w AS r2,
+             regr_intercept_resum(y, x) OVER w AS intercept, covar_samp_resum(y, x) OVER w AS covar
+      FROM p WINDOW w AS (ORDER BY i ROWS 17 PRECEDING)) AS r JOIN expected AS e USING (i)
+WHERE i NOT BETWEEN 40 AND 59 AND i NOT BETWEEN 120 AND 137 AND i NOT BETWEEN 200 AND 217
+  AND (abs(r.corr - e.corr) > 1e-9 OR abs(r.r2 - e.r2) > 1e-9
+       OR abs(r.intercept - e.intercept) > 1e-9 * abs(e.intercept) OR abs(r.covar - e.covar) > 1e-9 * abs(e.covar));
+
+-- The re-summing variants give the results of the default functions as aggregates.
+SELECT 'aggregate *_resum match the default functions',
+       iif(corr_resum(y, x) = corr(y, x) AND regr_slope_resum(y, x) = regr_slope(y, x)
+           AND regr_avgx_resum(y, x) = regr_avgx(y, x) AND regr_residual_stderr_resum(y, x) = regr_residual_stderr(y, x),
+           'ok', 'FAIL') FROM p;
+
+-- Beyond max_buffer_size, they continue like the default functions.
+SELECT 'max_buffer_size lowered', iif(stats_config('max_buffer_size', 64) = 64, 'ok', 'FAIL');
+SELECT 'sliding corr_resum without buffers matches corr',
+       iif(count(*) = 0, 'ok', 'FAIL at rows ' || group_concat(i))
+FROM (SELECT i, corr_resum(y, x) OVER w AS r, corr(y, x) OVER w AS d FROM p WINDOW w AS (ORDER BY i ROWS 17 PRECEDING))
+WHERE r IS NOT d;
+SELECT 'max_buffer_size restored', iif(stats_config('max_buffer_size', 268435456) = 268435456, 'ok', 'FAIL');
@@ -0,0 +1,28 @@
+-- Regression checks for the double-double precision (*_precise) functions.
+
+-- INTEGER inputs beyond 2^53 must not be rounded to double: 2^53 + 1 and
+-- 2^53 + 3 are not representable. The exact sample variance of
+-- 2^53 + 1, 2^53 + 2, 2^53 + 3 is 1 and the population variance is 2/3.
+CREATE TABLE big(i INTEGER PRIMARY KEY, v INTEGER);
+INSERT INTO big(v) VALUES (9007199254740993), (9007199254740994), (9007199254740995);
+
+SELECT 'variance_samp_precise of integers beyond 2^53',
+       iif(variance_samp_precise(v) = 1.0, 'ok', 'FAIL ' || variance_samp_precise(v)) FROM big;
+SELECT 'variance_pop_precise of integers beyond 2^53',
+       iif(variance_pop_precise(v) = 2.0 / 3, 'ok', 'FAIL ' || variance_pop_precise(v)) FROM big;
+
+-- The same with a REAL shift, so the INTEGERs are combined with it in
+-- double-double arithmetic: the deviations from 2^53 are 0, 1 and 3.
+CREATE TABLE mixed(i INTEGER PRIMARY KEY, v);
+INSERT INTO mixed(v) VALUES (9007199254740992.0), (9007199254740993), (9007199254740995);
+SELECT 'variance_pop_precise of a REAL followed by integers beyond 2^53',
+       iif(abs(variance_pop_precise(v) - 14.0 / 9) <= 1e-15, 'ok', 'FAIL ' || variance_pop_precise(v)) FROM mixed;
+
+-- A sliding frame over the integers agrees with the exact integer engine of the
+-- default functions on every row.
+WITH RECURSIVE seq(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM seq WHERE i < 50)
+INSERT INTO big(v) SELECT 9007199254740993 + (i * 7919) % 101 FROM seq;
+SELECT 'sliding stddev_samp_precise matches the exact integer engine',
+       iif(max(abs(p - e)) <= 1e-15 * max(e), 'ok', 'FAIL ' || max(abs(p - e)))
+FROM (SELECT stddev_samp_precise(v) OVER w AS p, stddev_samp(v) OVER w AS e
+      FROM big WINDOW w AS (ORDER BY i ROWS 4 PRECEDING));
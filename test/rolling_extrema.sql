@@ -0,0 +1,17 @@
+-- Regression checks for rolling_min, rolling_max and rolling_range.
+
+CREATE TABLE t(i INTEGER PRIMARY KEY, v);
+INSERT INTO t(v) VALUES (0.1), (0.3), (0.2), (1234567.891), (0.2), (0.1);
+
+-- A minimum or maximum is one of the frame's values, so the deques keep doubles
+-- even when float32_buffers is enabled.
+SELECT 'float32_buffers enabled', iif(stats_config('float32_buffers', 1) = 1, 'ok', 'FAIL');
+SELECT 'rolling_min of one row ignores float32_buffers',
+       iif(rolling_min(v) OVER (ORDER BY i ROWS 0 PRECEDING) = 0.1, 'ok',
+           'FAIL ' || rolling_min(v) OVER (ORDER BY i ROWS 0 PRECEDING)) FROM t WHERE i = 1;
+SELECT 'sliding rolling_min and rolling_max match min and max under float32_buffers',
+       iif(count(*) = 0, 'ok', 'FAIL at rows ' || group_concat(i))
+FROM (SELECT i, rolling_min(v) OVER w AS rmin, min(v) OVER w AS emin, rolling_max(v) OVER w AS rmax, max(v) OVER w AS emax
+      FROM t WINDOW w AS (ORDER BY i ROWS 2 PRECEDING))
+WHERE rmin IS NOT emin OR rmax IS NOT emax;
+SELECT 'float32_buffers disabled', iif(stats_config('float32_buffers', 0) = 0, 'ok', 'FAIL');
@@ -0,0 +1,35 @@
+#!/bin/sh
+# Builds the extension and runs the SQL regression checks in this directory.
+#
+# Every check is a query returning one row: a description and either `ok` or
+# `FAIL` followed by the value that was actually computed. The run fails if any
+# check fails or any statement raises an error.
+#
+# Usage: test/run.sh [sqlite3 executable]   (from the repository root)
+set -e
+
+SQLITE3=${1:-sqlite3}
+CC=${CC:-gcc}
+HERE=$(dirname "$0")
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+$CC -O2 -shared -fPIC -o "$BUILD/sqlite-stddev-extension.so" "$HERE/../sqlite-stddev-extension.c" -lm
+
+status=0
+for script in "$HERE"/*.sql; do
+    if ! output=$("$SQLITE3" -bail -list -separator ': ' -cmd ".load $BUILD/sqlite-stddev-extension.so" :memory: < "$script" 2>&1); then
+        status=1
+    fi
+    printf '%s\n' "$output" | sed "s|^|$(basename "$script"): |"
+    if printf '%s\n' "$output" | grep -q 'FAIL'; then
+        status=1
+    fi
+done
+
+if [ $status -ne 0 ]; then
+    echo "Some checks failed."
+else
+    echo "All checks passed."
+fi
+exit $status
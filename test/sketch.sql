@@ -0,0 +1,45 @@
+-- Regression checks for the approximate quantile sketch in sliding frames.
+
+-- A value spanning more than SKETCH_MAX_BUCKETS buckets forces the lowest buckets
+-- to be merged. Values removed later must be taken from the bucket they were
+-- merged into, and once the wide value has left, the frame must give the same
+-- estimate as a fresh sketch over the same rows.
+CREATE TABLE t(i INTEGER PRIMARY KEY, v);
+INSERT INTO t VALUES (1, 1e10), (2, 1e-10), (3, 1), (4, 1), (5, 1e-12), (6, 1e-9);
+
+SELECT 'sliding approx_quantile after a merge matches a fresh sketch',
+       iif(w = f, 'ok', 'FAIL ' || w || ' vs ' || f)
+FROM (SELECT approx_quantile(v, 1.0 / 3) OVER (ORDER BY i ROWS 3 PRECEDING) AS w FROM t LIMIT 1 OFFSET 5),
+     (SELECT approx_quantile(v, 1.0 / 3) AS f FROM t WHERE i >= 3);
+
+-- The same over a longer series: a few very large and very small values near
+-- the start force repeated merges, and every later frame must agree with a
+-- fresh sketch of its rows at every fraction.
+CREATE TABLE s(i INTEGER PRIMARY KEY, v);
+WITH RECURSIVE seq(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM seq WHERE i < 300)
+INSERT INTO s SELECT i, CASE WHEN i IN (3, 11, 17) THEN 1e12
+                             WHEN i IN (5, 13, 19) THEN 1e-12
+                             ELSE 1e-3 * ((i * 7919) % 997 + 1) END FROM seq;
+
+SELECT 'sliding approx_quantile over repeated merges matches fresh sketches',
+       iif(count(*) = 0, 'ok', 'FAIL at rows ' || group_concat(i))
+FROM (SELECT i, p, approx_quantile(v, p) OVER (PARTITION BY p ORDER BY i ROWS 7 PRECEDING) AS w
+      FROM s, (SELECT 0.0 AS p UNION ALL SELECT 0.25 UNION ALL SELECT 0.5 UNION ALL SELECT 1.0)) AS r
+WHERE i > 30
+  AND w IS NOT (SELECT approx_quantile(v, r.p) FROM s WHERE s.i BETWEEN r.i - 7 AND r.i);
+
+-- Bucket counts of a sliding sketch must never go negative. Here 1e-20 is merged
+-- when it arrives next to 1e20, and 1e-10 must be removed from the merged bucket
+-- rather than from its own. All values are positive, so the counts of the BLOB
+-- start at byte 50 (see `serialize_quantile_sketch`), and a negative count has
+-- its top bit set.
+CREATE TABLE wide(i INTEGER PRIMARY KEY, v);
+INSERT INTO wide VALUES (1, 1e20), (2, 1e-20), (3, 1e-10), (4, 1e-9), (5, 1e-9), (6, 1);
+CREATE TABLE slot(j INTEGER PRIMARY KEY);
+WITH RECURSIVE seq(j) AS (SELECT 0 UNION ALL SELECT j + 1 FROM seq WHERE j < 4095)
+INSERT INTO slot SELECT j FROM seq;
+
+SELECT 'sliding quantile_sketch bucket counts stay non-negative',
+       iif(count(*) = 0, 'ok', 'FAIL at rows ' || group_concat(DISTINCT i))
+FROM (SELECT i, quantile_sketch(v) OVER (ORDER BY i ROWS 1 PRECEDING) AS b FROM wide), slot
+WHERE 50 + 8 * j < length(b) AND substr(hex(b), 101 + 16 * j, 1) > '7';
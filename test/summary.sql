@@ -0,0 +1,39 @@
+-- Regression checks for stats_summary and stats_summary_blob.
+
+CREATE TABLE t(i INTEGER PRIMARY KEY, v);
+INSERT INTO t VALUES (1, 1), (2, 2), (3, 3);
+
+-- min and max stay known after rows have left a sliding frame.
+SELECT 'stats_summary reports min and max of a sliding frame',
+       iif(s = '{"count":2,"mean":2.5,"min":2.0,"max":3.0,"variance_samp":0.5,"variance_pop":0.25,"stddev_samp":0.7071067811865476,"stddev_pop":0.5,"stderr":0.5,"cv":0.282842712474619}',
+           'ok', 'FAIL ' || s)
+FROM (SELECT i, stats_summary(v) OVER (ORDER BY i ROWS 1 PRECEDING) AS s FROM t) WHERE i = 3;
+
+-- Every frame agrees with SQLite's min and max, including frames that drain to
+-- empty and start again.
+CREATE TABLE r(i INTEGER PRIMARY KEY, v);
+WITH RECURSIVE seq(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM seq WHERE i < 500)
+INSERT INTO r SELECT i, CASE WHEN i % 17 = 0 THEN NULL ELSE ((i * 7919) % 211) - 100 + (i % 3) * 0.25 END FROM seq;
+
+SELECT 'sliding summary_min and summary_max match min and max',
+       iif(count(*) = 0, 'ok', 'FAIL at rows ' || group_concat(i))
+FROM (SELECT i, stats_summary_blob(v) OVER w AS b, min(v) OVER w AS emin, max(v) OVER w AS emax
+      FROM r WINDOW w AS (ORDER BY i ROWS BETWEEN 5 PRECEDING AND 2 PRECEDING))
+WHERE summary_min(b) IS NOT emin OR summary_max(b) IS NOT emax;
+
+SELECT 'summary_min and summary_max after the frame drained',
+       iif(count(*) = 0, 'ok', 'FAIL at rows ' || group_concat(i))
+FROM (SELECT i, stats_summary_blob(v) OVER w AS b, min(v) OVER w AS emin, max(v) OVER w AS emax
+      FROM t WINDOW w AS (ORDER BY i ROWS BETWEEN 1 FOLLOWING AND 2 FOLLOWING))
+WHERE summary_min(b) IS NOT emin OR summary_max(b) IS NOT emax;
+
+-- If the deques outgrow max_buffer_size (ascending values keep every one of them
+-- as a minimum candidate), min and max become null after the next departure, and
+-- are known again once the frame has drained.
+SELECT 'max_buffer_size lowered', iif(stats_config('max_buffer_size', 64) = 64, 'ok', 'FAIL');
+SELECT 'stats_summary without deques reports unknown min as null',
+       iif(summary_min(b) IS NULL AND summary_count(b) = 20, 'ok', 'FAIL ' || summary_min(b))
+FROM (SELECT i, stats_summary_blob(i) OVER (ORDER BY i ROWS 19 PRECEDING) AS b FROM r WHERE i <= 100) WHERE i = 100;
+SELECT 'stats_summary without deques still reports an aggregate min',
+       iif(summary_min(stats_summary_blob(i)) = 1, 'ok', 'FAIL') FROM r;
+SELECT 'max_buffer_size restored', iif(stats_config('max_buffer_size', 268435456) = 268435456, 'ok', 'FAIL');
@@ -0,0 +1,41 @@
+-- Regression checks for time_weighted_avg, time_weighted_variance and time_weighted_stddev.
+
+CREATE TABLE t(ts, x);
+INSERT INTO t VALUES (0, 10), (1, 20), (2, 30), (3, 40), (4, 50), (10, 60);
+
+-- A sliding frame covers the intervals between its own rows, like the aggregate
+-- over the same rows: {2, 3, 4} holds 30 and 40 for one second each.
+SELECT 'sliding time_weighted_avg matches the aggregate over the frame',
+       iif(w = 35.0, 'ok', 'FAIL ' || w)
+FROM (SELECT ts, time_weighted_avg(x, ts) OVER (ORDER BY ts ROWS 2 PRECEDING) AS w FROM t) WHERE ts = 4;
+SELECT 'a frame holding one row has no elapsed time',
+       iif(w IS NULL, 'ok', 'FAIL ' || w)
+FROM (SELECT ts, time_weighted_avg(x, ts) OVER (ORDER BY ts ROWS BETWEEN 1 FOLLOWING AND 2 FOLLOWING) AS w FROM t) WHERE ts = 4;
+
+-- Every frame agrees with the aggregate over its rows, for ROWS and RANGE frames,
+-- frames that drain to empty, and NULLs.
+CREATE TABLE r(ts INTEGER PRIMARY KEY, x);
+WITH RECURSIVE seq(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM seq WHERE i < 200)
+INSERT INTO r SELECT i * 3 + (i * 7919) % 5, CASE WHEN i % 23 = 0 THEN NULL ELSE (i * 104729) % 97 END FROM seq;
+
+SELECT 'sliding ROWS frames match the aggregate over their rows',
+       iif(count(*) = 0, 'ok', 'FAIL at ts ' || group_concat(ts))
+FROM (SELECT ts, time_weighted_variance(x, ts) OVER (ORDER BY ts ROWS BETWEEN 6 PRECEDING AND 1 PRECEDING) AS w,
+             (SELECT time_weighted_variance(x, ts ORDER BY ts) FROM
+                (SELECT * FROM r AS q WHERE q.ts < o.ts ORDER BY q.ts DESC LIMIT 6)) AS e
+      FROM r AS o)
+WHERE NOT (w IS e OR abs(w - e) <= 1e-9 * e);
+
+SELECT 'sliding RANGE frames match the aggregate over their rows',
+       iif(count(*) = 0, 'ok', 'FAIL at ts ' || group_concat(ts))
+FROM (SELECT ts, time_weighted_avg(x, ts) OVER (ORDER BY ts RANGE BETWEEN 20 PRECEDING AND 5 FOLLOWING) AS w,
+             (SELECT time_weighted_avg(x, ts ORDER BY ts) FROM r AS q WHERE q.ts BETWEEN o.ts - 20 AND o.ts + 5) AS e
+      FROM r AS o)
+WHERE NOT (w IS e OR abs(w - e) <= 1e-9 * abs(e));
+
+-- Without a frame buffer, aggregates still work, but a row cannot leave a frame.
+SELECT 'max_buffer_size lowered', iif(stats_config('max_buffer_size', 64) = 64, 'ok', 'FAIL');
+SELECT 'time_weighted_avg aggregates beyond max_buffer_size',
+       iif(abs(time_weighted_avg(x, ts ORDER BY ts) - (SELECT time_weighted_avg(x, ts) OVER (ORDER BY ts ROWS UNBOUNDED PRECEDING) FROM r ORDER BY ts DESC LIMIT 1)) <= 1e-12,
+           'ok', 'FAIL') FROM r;
+SELECT 'max_buffer_size restored', iif(stats_config('max_buffer_size', 268435456) = 268435456, 'ok', 'FAIL');